@@ -30,62 +30,267 @@
 
 #include "DetectorConstruction.h"
 #include "ActionInitialization.h"
+#include "RunAction.h"
+#include "ScanManager.h"
+#include "ResponseManager.h"
+#include "PhysicsList.h"
+#include "InitializationMonitor.h"
+#include "PhysicsTableCache.h"
+#include "CacheFiles.h"
+#include "EmissionTable.h"
 
 #include "G4RunManagerFactory.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
+#include "G4UIcommand.hh"
 #include "Shielding.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "Randomize.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
+namespace
+{
+// SplitMix64 step, to derive independent seeds from a base seed
+std::uint64_t SplitMix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void PrintUsage()
+{
+    G4cerr
+        << " Usage: " << G4endl
+        << " absorber [macro]" << G4endl
+        << " absorber [-m macro] [-r serial|mt|tasking] [-t nThreads] [-n nEvents]" << G4endl
+        << "          [-s seed] [-k index/count] [-o outputDirectory] [-p Shielding|lean]" << G4endl
+        << "          [-c tableCacheDirectory] [-f 0|1]" << G4endl
+        << "   -m : macro run in batch mode, without visualization" << G4endl
+        << "        (interactive session with visualization if omitted)" << G4endl
+        << "   -r : run manager type" << G4endl
+        << "   -t : number of threads" << G4endl
+        << "   -n : number of events, value of the {nEvents} alias of the macros" << G4endl
+        << "   -s : base seed of the random engine" << G4endl
+        << "   -k : shard index (0 to count-1) of a sharded campaign" << G4endl
+        << "   -o : directory of the analysis files" << G4endl
+        << "   -p : physics list (default from ABSORBER_PHYSICS_LIST)" << G4endl
+        << "   -c : table cache (default from ABSORBER_TABLE_CACHE, none if unset)" << G4endl
+        << "   -f : fast simulation physics of the photons, for /det/setFastSim" << G4endl
+        << "        (default from ABSORBER_FAST_SIMULATION, off if unset)" << G4endl;
+}
+}
+
 int main(int argc, char** argv)
 {
-    // Detect interactive mode (if no arguments) and define UI session
+    // Evaluate arguments
+    //
+    G4String macro;
+    G4String runManagerName = "default";
+    G4int nofThreads = 0;
+    G4String nofEvents = "1000000";
+    G4long seed = 0;
+    G4bool seedSet = false;
+    G4int shardIndex = 0;
+    G4int shardCount = 0;
+    G4String outputDir;
+    G4String physicsListName = "Shielding";
+    if (auto env = std::getenv("ABSORBER_PHYSICS_LIST")) physicsListName = env;
+    const char* tableCacheOption = nullptr;
+    G4bool fastSimulation = false;
+    if (auto env = std::getenv("ABSORBER_FAST_SIMULATION")) fastSimulation = G4UIcommand::ConvertToBool(env);
+
+    if (argc == 2 && argv[1][0] != '-')
+    {
+        // Former usage: a single macro
+        macro = argv[1];
+    }
+    else
+    {
+        for (G4int i = 1; i < argc; i = i + 2)
+        {
+            G4String option = argv[i];
+            if (i + 1 >= argc)
+            {
+                PrintUsage();
+                return 1;
+            }
+            G4String value = argv[i + 1];
+
+            if (option == "-m") macro = value;
+            else if (option == "-r") runManagerName = value;
+            else if (option == "-t") nofThreads = G4UIcommand::ConvertToInt(value);
+            else if (option == "-n") nofEvents = value;
+            else if (option == "-s")
+            {
+                seed = G4UIcommand::ConvertToLongInt(value);
+                seedSet = true;
+            }
+            else if (option == "-k")
+            {
+                auto slash = value.find('/');
+                if (slash != std::string::npos)
+                {
+                    shardIndex = G4UIcommand::ConvertToInt(value.substr(0, slash).c_str());
+                    shardCount = G4UIcommand::ConvertToInt(value.substr(slash + 1).c_str());
+                }
+                if (shardCount <= 0 || shardIndex < 0 || shardIndex >= shardCount)
+                {
+                    PrintUsage();
+                    return 1;
+                }
+            }
+            else if (option == "-o") outputDir = value;
+            else if (option == "-p") physicsListName = value;
+            else if (option == "-c") tableCacheOption = argv[i + 1];
+            else if (option == "-f") fastSimulation = G4UIcommand::ConvertToBool(value);
+            else
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+    }
+
+    G4RunManagerType runManagerType = G4RunManagerType::Default;
+    if (runManagerName == "serial") runManagerType = G4RunManagerType::Serial;
+    else if (runManagerName == "mt") runManagerType = G4RunManagerType::MT;
+    else if (runManagerName == "tasking") runManagerType = G4RunManagerType::Tasking;
+    else if (runManagerName != "default")
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // Interactive mode without macro: the UI session is only created
+    // then, and the visualization in the same case below
     //
     G4UIExecutive* ui = nullptr;
-    if (argc == 1) ui = new G4UIExecutive(argc, argv);
+    if (macro.empty()) ui = new G4UIExecutive(argc, argv);
 
     // Use G4SteppingVerboseWithUnits
     constexpr G4int precision = 0;
     G4SteppingVerbose::UseBestUnit(precision);
 
-    // Construct the default run manager
+    // Construct the run manager
     //
-    auto runManager =
-        G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+    auto runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
+    if (nofThreads > 0) runManager->SetNumberOfThreads(nofThreads);
+
+    // Seeds of the master engine, derived from the base seed and the shard
+    // index; the engines of the worker threads are seeded event by event
+    // from the master one, which keeps the shards reproducible whatever
+    // the number of threads
+    G4long shardSeed = 0;
+    if (seedSet || shardCount > 0)
+    {
+        std::uint64_t state = static_cast<std::uint64_t>(seed);
+        for (G4int i = 0; i <= shardIndex; i++) SplitMix64(state);
+        auto value = SplitMix64(state);
+        long seeds[3] = {
+            static_cast<long>(value & 0x7fffffff) | 1,
+            static_cast<long>((value >> 32) & 0x7fffffff) | 1,
+            0 };
+        G4Random::setTheSeeds(seeds);
+        shardSeed = static_cast<G4long>(value & 0x7fffffffffffffffULL);
+    }
+    RunAction::SetShard(shardIndex, shardCount, seed, shardSeed);
+
+    // Analysis files, set before the threads are started
+    if (!outputDir.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(outputDir.c_str(), error);
+        RunAction::SetOutputDirectory(outputDir);
+    }
 
     // Set mandatory initialization classes
     //
     // Detector construction
-    runManager->SetUserInitialization(new DetectorConstruction);
+    auto detector = new DetectorConstruction;
+    detector->SetFastSimulationPhysics(fastSimulation);
+    runManager->SetUserInitialization(detector);
 
-    // Physics list
-    runManager->SetUserInitialization(new Shielding);
+    // Physics list: Shielding (default) or lean (EM and radioactive decay
+    // only); the fast simulation process, which every photon step pays for,
+    // only when requested
+    if (physicsListName == "lean")
+    {
+        runManager->SetUserInitialization(new PhysicsList(fastSimulation));
+    }
+    else
+    {
+        if (physicsListName != "Shielding")
+        {
+            G4cout << "Warning: unknown physics list " << physicsListName
+                << ", using Shielding." << G4endl;
+            physicsListName = "Shielding";
+        }
+        auto shielding = new Shielding;
+        shielding->RegisterPhysics(new G4StepLimiterPhysics);
+        if (fastSimulation)
+        {
+            auto fastSimulationPhysics = new G4FastSimulationPhysics;
+            fastSimulationPhysics->ActivateFastSimulation("gamma");
+            shielding->RegisterPhysics(fastSimulationPhysics);
+        }
+        runManager->SetUserInitialization(shielding);
+    }
+
+    // Report of the initialization time and memory
+    auto initMonitor = new InitializationMonitor(physicsListName);
+
+    // Table cache (physics, emission and response tables), only in the
+    // directory given by -c or by the ABSORBER_TABLE_CACHE environment
+    // variable (empty or "off" to disable)
+    auto tableCacheDir = CacheFiles::GetDirectory("", tableCacheOption);
+    auto tableCache = new PhysicsTableCache(tableCacheDir, physicsListName);
+    EmissionTable::SetCacheDirectory(tableCacheDir);
 
     // User action initialization
-    runManager->SetUserInitialization(new ActionInitialization);
+    runManager->SetUserInitialization(new ActionInitialization(detector));
+
+    // Absorber parameter sweep (/scan/ commands)
+    auto scanManager = new ScanManager(detector);
 
-    // Initialize visualization with the default graphics system
-    auto visManager = new G4VisExecutive(argc, argv);
-    // Constructors can also take optional arguments:
-    // - a graphics system of choice, eg. "OGL"
-    // - and a verbosity argument - see /vis/verbose guidance.
-    //auto visManager = new G4VisExecutive(argc, argv, "OGL", "Quiet");
-    //auto visManager = new G4VisExecutive("Quiet");
-    visManager->Initialize();
+    // Layer response matrices and stack folding (/resp/ commands)
+    auto responseManager = new ResponseManager(detector, physicsListName, tableCacheDir);
+
+    // Initialize visualization with the default graphics system,
+    // in interactive mode only
+    G4VisManager* visManager = nullptr;
+    if (ui)
+    {
+        visManager = new G4VisExecutive(argc, argv);
+        // Constructors can also take optional arguments:
+        // - a graphics system of choice, eg. "OGL"
+        // - and a verbosity argument - see /vis/verbose guidance.
+        //auto visManager = new G4VisExecutive(argc, argv, "OGL", "Quiet");
+        //auto visManager = new G4VisExecutive("Quiet");
+        visManager->Initialize();
+    }
 
     // Get the pointer to the User Interface manager
     auto UImanager = G4UImanager::GetUIpointer();
 
+    // Number of events of the macros: /run/beamOn {nEvents}
+    UImanager->ApplyCommand("/control/alias nEvents " + nofEvents);
+
     // Process macro or start UI session
     //
     if (!ui)
     {
         // batch mode
         G4String command = "/control/execute ";
-        G4String fileName = argv[1];
-        UImanager->ApplyCommand(command + fileName);
+        UImanager->ApplyCommand(command + macro);
     }
     else
     {
@@ -100,6 +305,10 @@ int main(int argc, char** argv)
     // owned and deleted by the run manager, so they should not be deleted
     // in the main() program !
 
+    delete responseManager;
+    delete scanManager;
+    delete initMonitor;
+    delete tableCache;
     delete visManager;
     delete runManager;
 }
@@ -0,0 +1,392 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber_bench.cpp
+/// \brief Benchmark of absorber on fixed-seed reference workloads
+/// Runs the example macros with a fixed seed at several thread counts,
+/// reads back the run summaries and telemetry files, compares the
+/// spectra with reference summaries within their statistical errors and
+/// the throughput, initialization time and peak memory with the
+/// reference performance of the same workload and thread count. With
+/// -u the references are (re)written from the runs instead.
+/// The spectrum references do not depend on the machine and are kept in
+/// the repository; the performance references are optional, written
+/// locally. Whatever the references, the spectra of every thread count
+/// are also checked against those of the first one.
+
+#include "RunSummary.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+struct Workload
+{
+    const char* macro;
+    const char* fileName;   // as set by /analysis/setFileName in the macro
+};
+
+const Workload workloads[] =
+{
+    { "Co60.mac", "Co60" },
+    { "Am241.mac", "Am241" },
+    { "Co60_1.mac", "Co60_Pb" },
+    { "Am241_1.mac", "Am241_Pb" }
+};
+
+struct Options
+{
+    std::string absorber;
+    std::string referenceDir;
+    std::string outputDir{ "benchmark_output" };
+    std::string runManager{ "mt" };
+    std::string nofEvents{ "100000" };
+    std::string seed{ "12345" };
+    std::vector<int> threads;
+    double tolerance{ 0.1 };
+    bool update{ false };
+};
+
+struct Performance
+{
+    double eventsPerSecond{ 0.0 };
+    double initTime{ 0.0 };
+    double peakMemory{ 0.0 };
+};
+
+void PrintUsage()
+{
+    std::cerr
+        << " Usage: " << std::endl
+        << " absorber_bench [-u] [-r runManager] [-n nEvents] [-s seed] [-o outputDirectory]" << std::endl
+        << "                [-x tolerance] absorber referenceDirectory [nThreads...]" << std::endl
+        << "   -u : write the references instead of checking against them" << std::endl
+        << "   -x : relative performance change flagged as a regression (default 0.1)" << std::endl;
+}
+
+// Value of a number field of the (flat) telemetry JSON
+double ReadJsonNumber(const std::string& text, const std::string& key)
+{
+    auto pos = text.find("\"" + key + "\":");
+    if (pos == std::string::npos) return 0.0;
+    return std::atof(text.c_str() + pos + key.size() + 3);
+}
+
+bool ReadTelemetry(const std::string& fileName, Performance& performance)
+{
+    std::ifstream input(fileName);
+    if (!input) return false;
+
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    auto text = buffer.str();
+
+    performance.eventsPerSecond = ReadJsonNumber(text, "events_per_s");
+    // The workers initialize once the master is done
+    performance.initTime = ReadJsonNumber(text, "master_kernel_init_time_s")
+        + ReadJsonNumber(text, "master_first_run_init_time_s")
+        + ReadJsonNumber(text, "worker_init_time_s");
+    performance.peakMemory = ReadJsonNumber(text, "peak_memory_bytes");
+    return true;
+}
+
+bool ReadPerformance(const std::string& fileName, Performance& performance)
+{
+    std::ifstream input(fileName);
+    if (!input) return false;
+
+    std::string key;
+    double value = 0.0;
+    while (input >> key >> value)
+    {
+        if (key == "events_per_s") performance.eventsPerSecond = value;
+        if (key == "init_time_s") performance.initTime = value;
+        if (key == "peak_memory_bytes") performance.peakMemory = value;
+    }
+    return true;
+}
+
+void WritePerformance(const std::string& fileName, const Performance& performance)
+{
+    std::ofstream output(fileName);
+    output << std::setprecision(6)
+        << "events_per_s " << performance.eventsPerSecond << '\n'
+        << "init_time_s " << performance.initTime << '\n'
+        << "peak_memory_bytes " << performance.peakMemory << '\n';
+}
+
+// Chi-square per degree of freedom of the differences of two spectra,
+// each bin weighed by the errors of both; returns false when the
+// spectra are statistically incompatible
+bool CompareSpectra(const RunSummary::Spectrum& a, const RunSummary::Spectrum& b, double& chi2PerDof,
+    double& maxPull)
+{
+    double chi2 = 0.0;
+    int dof = 0;
+    maxPull = 0.0;
+    for (std::size_t ibin = 0; ibin < std::max(a.bins.size(), b.bins.size()); ibin++)
+    {
+        double swa = ibin < a.bins.size() ? a.bins[ibin][1] : 0.0;
+        double sw2a = ibin < a.bins.size() ? a.bins[ibin][2] : 0.0;
+        double swb = ibin < b.bins.size() ? b.bins[ibin][1] : 0.0;
+        double sw2b = ibin < b.bins.size() ? b.bins[ibin][2] : 0.0;
+        if (sw2a + sw2b <= 0.0) continue;
+
+        double pull = (swa - swb) / std::sqrt(sw2a + sw2b);
+        chi2 += pull * pull;
+        maxPull = std::max(maxPull, std::abs(pull));
+        dof++;
+    }
+
+    chi2PerDof = dof > 0 ? chi2 / dof : 0.0;
+    double limit = 1.0 + 3.0 * std::sqrt(2.0 / std::max(dof, 1));
+    return chi2PerDof <= limit && maxPull <= 5.0;
+}
+
+// Compares the spectra of a run with the references, printing the
+// differing ones; false if any differs
+bool CheckSpectra(const RunSummary& summary, const RunSummary& references, const std::string& against)
+{
+    static const RunSummary::Spectrum empty;
+
+    bool ok = true;
+    for (const auto& [ih, reference] : references.spectra)
+    {
+        auto it = summary.spectra.find(ih);
+        const auto& spectrum = it != summary.spectra.end() ? it->second : empty;
+
+        double chi2PerDof = 0.0, maxPull = 0.0;
+        if (!CompareSpectra(spectrum, reference, chi2PerDof, maxPull))
+        {
+            std::cout << ", spectrum " << ih << " differs" << against << " (chi2/dof " << chi2PerDof
+                << ", max pull " << maxPull << ")";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Positive when worse than the reference by more than the tolerance
+bool IsRegression(double value, double reference, double tolerance, bool higherIsBetter)
+{
+    if (reference <= 0.0) return false;
+    double change = (value - reference) / reference;
+    return higherIsBetter ? change < -tolerance : change > tolerance;
+}
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<std::string> arguments;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "-u")
+        {
+            options.update = true;
+            continue;
+        }
+        if (option.size() == 2 && option[0] == '-' && !std::isdigit(option[1]))
+        {
+            if (i + 1 >= argc)
+            {
+                PrintUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (option == "-r") options.runManager = value;
+            else if (option == "-n") options.nofEvents = value;
+            else if (option == "-s") options.seed = value;
+            else if (option == "-o") options.outputDir = value;
+            else if (option == "-x") options.tolerance = std::atof(value.c_str());
+            else
+            {
+                PrintUsage();
+                return 1;
+            }
+            continue;
+        }
+        arguments.push_back(option);
+    }
+
+    if (arguments.size() < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    options.absorber = arguments[0];
+    options.referenceDir = arguments[1];
+    for (std::size_t i = 2; i < arguments.size(); i++) options.threads.push_back(std::atoi(arguments[i].c_str()));
+    if (options.threads.empty()) options.threads = { 1, 2, 4 };
+
+    std::error_code error;
+    fs::create_directories(options.outputDir, error);
+    if (options.update) fs::create_directories(options.referenceDir, error);
+
+    int nofFailures = 0;
+
+    std::cout << std::setprecision(4);
+    for (const auto& workload : workloads)
+    {
+        // Run of the first thread count, for the others to agree with
+        RunSummary firstSummary;
+        bool hasFirstSummary = false;
+
+        for (auto nofThreads : options.threads)
+        {
+            std::ostringstream name;
+            name << workload.fileName << "_t" << nofThreads;
+            auto runDir = (fs::path(options.outputDir) / name.str()).string();
+            fs::create_directories(runDir, error);
+
+            // Same seed and events for all the thread counts: the events
+            // get the same seeds, the spectra must agree
+            std::ostringstream command;
+            command << '"' << options.absorber << '"'
+                << " -m " << workload.macro
+                << " -r " << options.runManager
+                << " -t " << nofThreads
+                << " -n " << options.nofEvents
+                << " -s " << options.seed
+                << " -o \"" << runDir << '"'
+                << " > \"" << (fs::path(runDir) / "absorber.log").string() << "\" 2>&1";
+
+            std::cout << " " << name.str() << ": " << std::flush;
+            if (std::system(command.str().c_str()) != 0)
+            {
+                std::cout << "FAILED (see " << runDir << "/absorber.log)" << std::endl;
+                nofFailures++;
+                continue;
+            }
+
+            auto outputBase = (fs::path(runDir) / workload.fileName).string();
+            RunSummary summary;
+            Performance performance;
+            if (!summary.Read(outputBase + ".summary")
+                || !ReadTelemetry(outputBase + "_telemetry.json", performance))
+            {
+                std::cout << "FAILED (no run summary or telemetry)" << std::endl;
+                nofFailures++;
+                continue;
+            }
+
+            if (nofThreads == options.threads.front())
+            {
+                firstSummary = summary;
+                hasFirstSummary = true;
+            }
+
+            std::cout << performance.eventsPerSecond << " events/s, init "
+                << performance.initTime << " s, peak memory "
+                << performance.peakMemory / (1024. * 1024.) << " MB";
+
+            auto referenceBase = (fs::path(options.referenceDir) / workload.fileName).string();
+            auto performanceFile = (fs::path(options.referenceDir) / (name.str() + ".perf")).string();
+
+            if (options.update)
+            {
+                // The spectra do not depend on the thread count
+                if (nofThreads == options.threads.front())
+                {
+                    fs::copy_file(outputBase + ".summary", referenceBase + ".summary",
+                        fs::copy_options::overwrite_existing, error);
+                }
+                WritePerformance(performanceFile, performance);
+                std::cout << ", reference written" << std::endl;
+                continue;
+            }
+
+            // Spectra, against the references (if any, see benchmark_update)
+            // and against the first thread count: same seeds, same spectra
+            RunSummary references;
+            bool ok = true;
+            if (references.Read(referenceBase + ".summary"))
+            {
+                ok = CheckSpectra(summary, references, "") && ok;
+            }
+            else
+            {
+                std::cout << ", no reference spectra";
+            }
+            if (hasFirstSummary && nofThreads != options.threads.front())
+            {
+                std::ostringstream against;
+                against << " from " << options.threads.front() << " thread(s)";
+                ok = CheckSpectra(summary, firstSummary, against.str()) && ok;
+            }
+
+            // Performance
+            Performance reference;
+            if (ReadPerformance(performanceFile, reference))
+            {
+                if (IsRegression(performance.eventsPerSecond, reference.eventsPerSecond, options.tolerance, true))
+                {
+                    std::cout << ", throughput regression (reference " << reference.eventsPerSecond << ")";
+                    ok = false;
+                }
+                if (IsRegression(performance.initTime, reference.initTime, options.tolerance, false))
+                {
+                    std::cout << ", init time regression (reference " << reference.initTime << " s)";
+                    ok = false;
+                }
+                if (IsRegression(performance.peakMemory, reference.peakMemory, options.tolerance, false))
+                {
+                    std::cout << ", memory regression (reference "
+                        << reference.peakMemory / (1024. * 1024.) << " MB)";
+                    ok = false;
+                }
+            }
+            else
+            {
+                std::cout << ", no reference performance";
+            }
+
+            std::cout << (ok ? ", OK" : ", REGRESSION") << std::endl;
+            if (!ok) nofFailures++;
+        }
+    }
+
+    if (nofFailures > 0)
+    {
+        std::cout << " " << nofFailures << " benchmark(s) failed or regressed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,225 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber_merge.cpp
+/// \brief Merge of the run summaries of a sharded campaign
+/// Sums the spectra and the kinetic energy totals written by absorber
+/// in its .summary files, the shards being taken in index order so that
+/// the result does not depend on the order of the arguments. A merged
+/// summary lists its shards, it can be merged again with the others.
+
+#include "RunSummary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Shard
+{
+    std::string fileName;
+    RunSummary summary;
+};
+
+void PrintUsage()
+{
+    std::cerr
+        << " Usage: " << std::endl
+        << " absorber_merge output.summary input.summary..." << std::endl;
+}
+
+bool Accumulate(const Shard& shard, RunSummary& merged)
+{
+    const auto& summary = shard.summary;
+    merged.nofEvents += summary.nofEvents;
+
+    for (const auto& [ih, totals] : summary.ekin)
+    {
+        auto& sum = merged.ekin[ih];
+        sum[0] += totals[0];
+        sum[1] += totals[1];
+    }
+
+    for (const auto& [ih, totals] : summary.sums)
+    {
+        auto& sum = merged.sums[ih];
+        sum[0] += totals[0];
+        sum[1] += totals[1];
+    }
+
+    for (const auto& [ih, spectrum] : summary.spectra)
+    {
+        auto& histogram = merged.spectra[ih];
+        if (histogram.edges.empty())
+        {
+            histogram.nbins = spectrum.nbins;
+            histogram.edges = spectrum.edges;
+        }
+        else if (histogram.nbins != spectrum.nbins || histogram.edges != spectrum.edges)
+        {
+            std::cerr << shard.fileName << ": binning of spectrum " << ih
+                << " differs from the previous shards" << std::endl;
+            return false;
+        }
+
+        if (histogram.bins.size() < spectrum.bins.size()) histogram.bins.resize(spectrum.bins.size());
+        for (std::size_t ibin = 0; ibin < spectrum.bins.size(); ibin++)
+        {
+            for (std::size_t i = 0; i < spectrum.bins[ibin].size(); i++)
+            {
+                histogram.bins[ibin][i] += spectrum.bins[ibin][i];
+            }
+        }
+    }
+
+    return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // Summaries first, to check the campaign and to order the shards
+    std::vector<Shard> shards;
+    for (int i = 2; i < argc; i++)
+    {
+        Shard shard{ argv[i], {} };
+        if (!shard.summary.Read(shard.fileName)
+            || shard.summary.shardIndex < 0 || shard.summary.shardCount <= 0)
+        {
+            std::cerr << argv[i] << ": not a run summary" << std::endl;
+            return 1;
+        }
+        shards.push_back(std::move(shard));
+    }
+
+    // Merged summaries are ordered by their lowest shard
+    std::sort(shards.begin(), shards.end(),
+        [](const Shard& a, const Shard& b) { return a.summary.shardIndices[0] < b.summary.shardIndices[0]; });
+
+    const auto& first = shards[0].summary;
+    std::set<int> indices;
+    for (const auto& shard : shards)
+    {
+        const auto& summary = shard.summary;
+        if (summary.shardCount != first.shardCount || summary.baseSeed != first.baseSeed)
+        {
+            std::cerr << shard.fileName << ": shard of another campaign" << std::endl;
+            return 1;
+        }
+        for (auto index : summary.shardIndices)
+        {
+            if (!indices.insert(index).second)
+            {
+                std::cerr << shard.fileName << ": shard " << index << " given twice" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    int shardCount = first.shardCount;
+    if (static_cast<int>(indices.size()) != shardCount)
+    {
+        std::cerr << "Warning: " << indices.size() << " of " << shardCount
+            << " shards merged" << std::endl;
+    }
+
+    // One shard after the other
+    RunSummary merged;
+    for (const auto& shard : shards)
+    {
+        if (!Accumulate(shard, merged)) return 1;
+    }
+
+    std::ofstream output(argv[1]);
+    if (!output)
+    {
+        std::cerr << argv[1] << ": cannot be written" << std::endl;
+        return 1;
+    }
+
+    output << std::setprecision(17);
+    output << "# absorber run summary" << '\n';
+    output << "# merged " << indices.size() << " of " << shardCount << " shards" << '\n';
+    output << "shard " << *indices.begin() << ' ' << shardCount << '\n';
+    output << "shards";
+    for (auto index : indices) output << ' ' << index;
+    output << '\n';
+    output << "seed " << first.baseSeed << " 0" << '\n';
+    output << "events " << merged.nofEvents << '\n';
+
+    for (const auto& [ih, totals] : merged.ekin)
+    {
+        output << "ekin " << ih << ' ' << totals[0] << ' ' << totals[1] << '\n';
+    }
+
+    for (const auto& [ih, totals] : merged.sums)
+    {
+        output << "sum " << ih << ' ' << totals[0] << ' ' << totals[1] << '\n';
+    }
+
+    for (const auto& [ih, histogram] : merged.spectra)
+    {
+        output << "h1 " << ih << ' ' << histogram.nbins;
+        for (auto edge : histogram.edges) output << ' ' << edge;
+        output << '\n';
+        for (std::size_t ibin = 0; ibin < histogram.bins.size(); ibin++)
+        {
+            const auto& bin = histogram.bins[ibin];
+            output << "bin " << ibin;
+            for (auto value : bin) output << ' ' << value;
+            output << '\n';
+        }
+
+        double sum = 0.0, sum2 = 0.0;
+        for (std::size_t ibin = 1; ibin + 1 < histogram.bins.size(); ibin++)
+        {
+            sum += histogram.bins[ibin][1];
+            sum2 += histogram.bins[ibin][2];
+        }
+
+        // Per history when the shards give it
+        auto it = merged.sums.find(ih);
+        if (it != merged.sums.end()) sum2 = it->second[1];
+        std::cout << " Spectrum " << ih << ": sum of weights " << sum;
+        if (sum > 0.0) std::cout << ", rel. error " << std::sqrt(sum2) / sum;
+        std::cout << std::endl;
+    }
+
+    std::cout << " " << merged.nofEvents << " events merged into " << argv[1] << std::endl;
+}
@@ -34,16 +34,21 @@
 
 #include "G4VUserActionInitialization.hh"
 
+class DetectorConstruction;
+
 /// Action initialization class.
 
 class ActionInitialization : public G4VUserActionInitialization
 {
 public:
-	ActionInitialization() = default;
+	ActionInitialization(DetectorConstruction*);
 	~ActionInitialization() override = default;
 
 	void BuildForMaster() const override;
 	void Build() const override;
+
+private:
+	DetectorConstruction* fDetConstruction{ nullptr };
 };
 
 #endif // !ActionInitialization_h
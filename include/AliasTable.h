@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/AliasTable.h
+/// \brief Definition of the AliasTable class
+
+#pragma once
+
+#ifndef AliasTable_h
+#define AliasTable_h
+
+#include "globals.hh"
+#include <vector>
+
+/// Walker's alias table: samples one of n weighted entries in constant
+/// time from two uniform random numbers.
+
+class AliasTable
+{
+public:
+	/// Build the table of the given (non-negative) weights
+	void Build(const std::vector<G4double>& weights);
+
+	inline std::size_t Sample(G4double u1, G4double u2) const;
+
+	std::size_t GetSize() const { return fAlias.size(); }
+
+private:
+	std::vector<G4double> fProbability;
+	std::vector<std::size_t> fAlias;
+};
+
+inline std::size_t AliasTable::Sample(G4double u1, G4double u2) const
+{
+	auto i = static_cast<std::size_t>(u1 * fAlias.size());
+	if (i >= fAlias.size()) i = fAlias.size() - 1;
+	return (u2 < fProbability[i]) ? i : fAlias[i];
+}
+
+#endif // !AliasTable_h
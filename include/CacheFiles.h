@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/CacheFiles.h
+/// \brief Definition of the CacheFiles class
+
+#pragma once
+
+#ifndef CacheFiles_h
+#define CacheFiles_h
+
+#include "globals.hh"
+#include <functional>
+#include <ostream>
+
+/// Files of the on-disk caches (emission tables, response matrices and
+/// physics tables), shared by concurrent jobs.
+///
+/// An entry is written aside, to a name of this process, and renamed in
+/// place once complete: another job sees it either complete or absent.
+
+class CacheFiles
+{
+public:
+	/// Cache directory given by value, or else by the ABSORBER_TABLE_CACHE
+	/// environment variable, or else the default one; empty or "off"
+	/// disable the cache (empty result)
+	static G4String GetDirectory(const G4String& defaultDirectory, const char* value = nullptr);
+
+	/// Path aside of the given one, unique to this process
+	static G4String GetTmpPath(const G4String& path);
+
+	/// Renames the entry written aside in place, or removes it if this
+	/// fails (e.g. when another job stored the same entry meanwhile)
+	static G4bool Commit(const G4String& tmpPath, const G4String& path);
+
+	/// Writes a file through write (false on error) and commits it;
+	/// the parent directories are created as needed
+	static G4bool Write(const G4String& fileName, const std::function<G4bool(std::ostream&)>& write);
+};
+
+#endif // !CacheFiles_h
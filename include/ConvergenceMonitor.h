@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ConvergenceMonitor.h
+/// \brief Definition of the ConvergenceMonitor class
+
+#pragma once
+
+#ifndef ConvergenceMonitor_h
+#define ConvergenceMonitor_h
+
+#include "globals.hh"
+#include "G4Threading.hh"
+#include <vector>
+
+/// Run termination on statistical convergence.
+///
+/// The worker run actions publish the totals of their spectra at regular
+/// event checkpoints; the monitor sums them over the threads and, once all
+/// the precision targets are met, softly aborts the run (the current events
+/// are completed). The number of events of /run/beamOn is the hard cap.
+/// Per spectrum the targets are the relative error of the integral, the
+/// largest relative error of the filled bins and the number of entries;
+/// a negative value disables a target.
+
+class ConvergenceMonitor
+{
+public:
+	struct Targets
+	{
+		std::vector<G4double> relError;
+		std::vector<G4double> binRelError;
+		std::vector<G4double> entries;
+		G4int minEvents{ 0 };
+		G4int checkInterval{ 10000 };
+
+		G4bool IsActive() const;
+	};
+
+	struct Spectrum
+	{
+		std::vector<G4double> entries;
+		std::vector<G4double> sw;
+		std::vector<G4double> sw2;
+		G4double sum2{ 0.0 };   // of the integral, per history
+	};
+
+	struct Contribution
+	{
+		G4int nofEvents{ 0 };
+		std::vector<Spectrum> spectra;
+	};
+
+	static ConvergenceMonitor* Instance();
+
+	/// Called by the master at begin of run, before the workers start
+	void Configure(const Targets& targets);
+
+	/// Called by each scoring thread at begin of run, returns its slot
+	G4int Register();
+
+	/// Replaces the totals of a thread and checks the targets
+	void Publish(G4int slot, const Contribution& contribution);
+
+	G4bool IsConverged() const { return fConverged; }
+	G4int GetConvergedEvents() const { return fConvergedEvents; }
+
+private:
+	ConvergenceMonitor() = default;
+
+	G4bool CheckTargets() const;
+
+	G4Mutex fMutex = G4MUTEX_INITIALIZER;
+	Targets fTargets;
+	std::vector<Contribution> fContributions;
+	G4bool fConverged{ false };
+	G4int fConvergedEvents{ 0 };
+};
+
+#endif // !ConvergenceMonitor_h
@@ -33,32 +33,165 @@
 #define DetectorConstruction_h
 
 #include "G4VUserDetectorConstruction.hh"
+#include "G4ThreeVector.hh"
+#include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+class G4Material;
+class G4LogicalVolume;
+class G4ProductionCuts;
+class G4UserLimits;
 class DetectorMessenger;
+class RunAction;
 
 /// Detector construction class to define materials and geometry.
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
 public:
+	/// Scoring modes: every step in the world is checked by SteppingAction,
+	/// or only steps in the detector reach DetectorSD
+	enum ScoringMode { kStepScoring, kBoundaryScoring };
+
+	/// Importance of the absorber layers: none, set per layer,
+	/// or derived from the gamma attenuation of each layer
+	enum ImportanceMode { kNoImportance, kManualImportance, kAutoImportance };
+
+	/// Production cuts of the absorber regions: the default cuts, set per
+	/// layer, or a fraction of the thickness of each layer; the region cuts
+	/// apply to e-, e+ and protons, the gammas keep the default cut
+	enum CutMode { kDefaultCuts, kManualCuts, kAutoCuts };
+
+	/// Absorber stack and its per layer settings, to be restored
+	/// after temporary changes
+	struct Stack
+	{
+		G4bool wantAbso{ false };
+		G4int nbOfAbso{ 0 };
+		std::vector<G4double> thick;
+		std::vector<G4String> mat;
+		std::vector<G4double> importance;
+		std::vector<G4double> cut;
+		std::vector<G4bool> fastSimulation;
+	};
+
 	DetectorConstruction();
 	~DetectorConstruction() override;
 
 	G4VPhysicalVolume* Construct() override;
+	void ConstructSDandField() override;
+
+	/// Run action of the calling thread, given to its sensitive detector;
+	/// set when the actions are built, before ConstructSDandField
+	static void SetRunAction(RunAction* runAction) { fRunAction = runAction; }
 
 	void SetWantAbso(G4bool bAbso) { fIWantAbso = bAbso; }
 	void SetNbOfAbso(G4int nb) { fNbOfAbso = nb; }
-	void SetAbso1Thick(G4double thick);
-	void SetAbso2Thick(G4double thick);
-	void SetAbso3Thick(G4double thick);
-	void SetAbso4Thick(G4double thick);
-	void SetAbso1Mat(G4String mat);
-	void SetAbso2Mat(G4String mat);
-	void SetAbso3Mat(G4String mat);
-	void SetAbso4Mat(G4String mat);
+	void SetAbsoThick(G4int i, G4double thick);
+	void SetAbsoMat(G4int i, const G4String& mat);
+	void SetCollapseLayers(G4bool collapse) { fCollapseLayers = collapse; }
+
+	void ClearAbsorbers();
+	void AddAbsorber(const G4String& mat, G4double thick);
+	void ReadLayerTable(const G4String& fileName);
+
+	Stack GetStack() const;
+	void SetStack(const Stack& stack);
+
+	void SetScoringMode(ScoringMode mode) { fScoringMode = mode; }
+	ScoringMode GetScoringMode() const { return fScoringMode; }
+
+	/// Score the particles leaving the stack through its exit face, where
+	/// they are killed, instead of those entering the detector
+	void SetExitPlaneScoring(G4bool value) { fExitPlaneScoring = value; }
+	G4bool GetExitPlaneScoring() const { return fExitPlaneScoring; }
+
+	void SetImportanceMode(ImportanceMode mode) { fImportanceMode = mode; }
+	ImportanceMode GetImportanceMode() const { return fImportanceMode; }
+	void SetLayerImportance(G4int i, G4double importance);
+	void SetImportanceEnergy(G4double energy) { fImportanceEnergy = energy; }
+	void SetMaxImportanceRatio(G4double ratio) { fMaxImportanceRatio = ratio; }
+
+	/// Each absorber volume and the detector are built in their own region
+	void SetCutMode(CutMode mode) { fCutMode = mode; }
+	CutMode GetCutMode() const { return fCutMode; }
+	void SetLayerCut(G4int i, G4double cut);
+	void SetDetectorCut(G4double cut) { fDetectorCut = cut; }
+	G4double GetDetectorCut() const { return fDetectorCut; }
+	void SetAutoCutFraction(G4double fraction) { fAutoCutFraction = fraction; }
+
+	/// Production cut of a layer without a cut of its own, 0 for the
+	/// default cuts
+	G4double GetAbsorberCut(G4double thick) const;
+
+	/// User limits of the absorbers, 0 for no limit; applied by the
+	/// step limiter and special cuts processes of the physics list
+	void SetMaxStep(G4double step) { fMaxStep = step; }
+	void SetMinKinEnergy(G4double energy) { fMinKinEnergy = energy; }
+	G4double GetMaxStep() const { return fMaxStep; }
+	G4double GetMinKinEnergy() const { return fMinKinEnergy; }
+
+	/// Whether the physics list has the fast simulation process (set by
+	/// main), without which the fast simulation cannot be selected
+	void SetFastSimulationPhysics(G4bool value) { fFastSimulationPhysics = value; }
+	G4bool HasFastSimulationPhysics() const { return fFastSimulationPhysics; }
+
+	/// Fast simulation of the photons entering the absorbers (see
+	/// SlabGammaModel), in every layer not excluded explicitly, with the
+	/// transmission tables of the slabs published beforehand
+	/// (/resp/prepareFastSim)
+	void SetFastSimulation(G4bool value);
+	G4bool GetFastSimulation() const { return fFastSimulation; }
+	void SetLayerFastSimulation(G4int i, G4bool value);
+	void SetFastSimulationEnergyRange(G4double minEnergy, G4double maxEnergy);
+
+	/// Material and thickness of each slab (group of layers) of the stack
+	/// simulated fast
+	std::vector<std::pair<G4String, G4double>> GetFastSimulationSlabs() const;
+
+	/// Kill the tracks in the world whose straight path misses the
+	/// stack and detector; with backscatter kept, only those leaving
+	/// radially or downstream of the detector
+	void SetAcceptanceCulling(G4bool value) { fAcceptanceCulling = value; }
+	G4bool GetAcceptanceCulling() const { return fAcceptanceCulling; }
+	void SetKeepBackscatter(G4bool value) { fKeepBackscatter = value; }
+	G4bool GetKeepBackscatter() const { return fKeepBackscatter; }
+
+	/// Importance of each built layer, computed in the calling thread
+	std::vector<G4double> ComputeImportances() const;
+
+	/// Index of the layer for a volume and its copy number, -1 if none
+	inline G4int GetLayerIndex(const G4VPhysicalVolume* volume, G4int copyNo) const;
+
+	G4VPhysicalVolume* GetDetector() const { return fDetectorPV; }
+
+	// Extents of the built geometry: the stack and the detector
+	// are coaxial cylinders along z
+	G4double GetRadius() const { return fRadius; }
+	G4double GetStackFrontZ() const { return fStackFrontZ; }
+	G4double GetDetectorFrontZ() const { return fDetectorFrontZ; }
+	G4double GetDetectorBackZ() const { return fDetectorBackZ; }
+
+	/// Distance along a straight path to the cylinder of the stack radius
+	/// between frontZ and backZ, 0 inside it, -1 if the path misses it
+	/// (as from its surface outward)
+	G4double GetDistanceToCylinder(const G4ThreeVector& position,
+		const G4ThreeVector& direction, G4double frontZ, G4double backZ) const;
 
 private:
+	G4Material* GetMaterial(const G4String& name);
+	G4double GetLayerImportance(G4int i) const;
+	G4double GetLayerCut(G4int i) const;
+	G4bool GetLayerFastSimulation(G4int i) const;
+	G4int GetNbOfGroupedLayers(G4int i) const;
+	void ConstructFastSimulation();
+	void SetRegion(G4LogicalVolume* volume, G4double cut);
+	G4UserLimits* GetUserLimits();
+
+	static G4ThreadLocal RunAction* fRunAction;
+
 	DetectorMessenger* fMessenger{ nullptr };
 
 	G4bool fIWantAbso{ false };
@@ -66,6 +199,63 @@ private:
 
 	std::vector<G4double> fAbsoThick;
 	std::vector<G4String> fAbsoMat;
+	G4bool fCollapseLayers{ false };
+
+	std::map<G4String, G4Material*> fMaterials;
+
+	ScoringMode fScoringMode{ kStepScoring };
+	G4bool fExitPlaneScoring{ false };
+
+	ImportanceMode fImportanceMode{ kNoImportance };
+	std::vector<G4double> fAbsoImportance;
+	G4double fImportanceEnergy{ 0.0 };
+	G4double fMaxImportanceRatio{ 4.0 };
+
+	CutMode fCutMode{ kDefaultCuts };
+	std::vector<G4double> fAbsoCut;
+	G4double fDetectorCut{ 0.0 };
+	G4double fAutoCutFraction{ 0.1 };
+	std::map<G4String, G4ProductionCuts*> fRegionCuts;
+
+	G4double fMaxStep{ 0.0 };
+	G4double fMinKinEnergy{ 0.0 };
+	G4UserLimits* fUserLimits{ nullptr };
+
+	G4bool fFastSimulationPhysics{ false };
+	G4bool fFastSimulation{ false };
+	std::vector<G4bool> fAbsoFastSimulation;
+	G4double fFastSimMinEnergy{ 0.0 };
+	G4double fFastSimMaxEnergy{ 0.0 };
+
+	G4bool fAcceptanceCulling{ false };
+	G4bool fKeepBackscatter{ false };
+
+	// Built layers: first layer of each volume, material of each layer
+	std::unordered_map<const G4VPhysicalVolume*, G4int> fLayerIndex;
+	std::vector<const G4Material*> fLayerMat;
+
+	// Built absorber regions, with the slab of those simulated fast
+	struct AbsorberRegion
+	{
+		G4String name;
+		G4bool fast{ false };
+		G4String material;
+		G4double thickness{ 0.0 };
+	};
+	std::vector<AbsorberRegion> fAbsorberRegions;
+
+	G4VPhysicalVolume* fDetectorPV{ nullptr };
+	G4double fRadius{ 0.0 };
+	G4double fStackFrontZ{ 0.0 };
+	G4double fDetectorFrontZ{ 0.0 };
+	G4double fDetectorBackZ{ 0.0 };
 };
 
+inline G4int DetectorConstruction::GetLayerIndex(const G4VPhysicalVolume* volume,
+	G4int copyNo) const
+{
+	auto it = fLayerIndex.find(volume);
+	return (it != fLayerIndex.end()) ? it->second + copyNo : -1;
+}
+
 #endif // !DetectorConstruction_h
@@ -49,9 +49,30 @@ class DetectorConstruction;
 /// Messenger class that defines commands for DetectorConstruction.
 ///
 /// It implements commands:
-/// - /B2/det/setTargetMaterial name
-/// - /B2/det/setChamberMaterial name
-/// - /B2/det/stepMax value unit
+/// - /det/setAbsorber bool
+/// - /det/setNbOfAbsoCmd nb
+/// - /det/setAbso[1-4]Thick value unit
+/// - /det/setAbso[1-4]Mat name
+/// - /det/addLayer name value unit
+/// - /det/clearLayers
+/// - /det/readLayerTable fileName
+/// - /det/collapseLayers bool
+/// - /det/setScoringMode step|boundary
+/// - /det/setImportanceMode off|manual|auto
+/// - /det/setLayerImportance index value
+/// - /det/setImportanceEnergy value unit
+/// - /det/setMaxImportanceRatio value
+/// - /det/setCutMode default|manual|auto
+/// - /det/setLayerCut index value unit
+/// - /det/setDetectorCut value unit
+/// - /det/setAutoCutFraction value
+/// - /det/setMaxStep value unit
+/// - /det/setMinKinEnergy value unit
+/// - /det/setFastSim bool
+/// - /det/setLayerFastSim index bool
+/// - /det/setFastSimEnergyRange min max unit
+/// - /det/setAcceptanceCulling bool
+/// - /det/setKeepBackscatter bool
 
 class DetectorMessenger : public G4UImessenger
 {
@@ -75,6 +96,26 @@ private:
 	G4UIcmdWithAString* fAbso3MatCmd{ nullptr };
 	G4UIcmdWithADoubleAndUnit* fAbso4ThickCmd{ nullptr };
 	G4UIcmdWithAString* fAbso4MatCmd{ nullptr };
+	G4UIcommand* fAddLayerCmd{ nullptr };
+	G4UIcmdWithoutParameter* fClearLayersCmd{ nullptr };
+	G4UIcmdWithAString* fLayerTableCmd{ nullptr };
+	G4UIcmdWithABool* fCollapseLayersCmd{ nullptr };
+	G4UIcmdWithAString* fScoringModeCmd{ nullptr };
+	G4UIcmdWithAString* fImportanceModeCmd{ nullptr };
+	G4UIcommand* fLayerImportanceCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fImportanceEnergyCmd{ nullptr };
+	G4UIcmdWithADouble* fMaxImportanceRatioCmd{ nullptr };
+	G4UIcmdWithAString* fCutModeCmd{ nullptr };
+	G4UIcommand* fLayerCutCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fDetectorCutCmd{ nullptr };
+	G4UIcmdWithADouble* fAutoCutFractionCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fMaxStepCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fMinKinEnergyCmd{ nullptr };
+	G4UIcmdWithABool* fFastSimCmd{ nullptr };
+	G4UIcommand* fLayerFastSimCmd{ nullptr };
+	G4UIcommand* fFastSimEnergyRangeCmd{ nullptr };
+	G4UIcmdWithABool* fAcceptanceCullingCmd{ nullptr };
+	G4UIcmdWithABool* fKeepBackscatterCmd{ nullptr };
 };
 
 #endif // !DetectorMessenger_h
@@ -0,0 +1,56 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/DetectorSD.h
+/// \brief Definition of the DetectorSD class
+
+#pragma once
+
+#ifndef DetectorSD_h
+#define DetectorSD_h
+
+#include "G4VSensitiveDetector.hh"
+
+class RunAction;
+
+/// Sensitive detector scoring the particles entering the Detector volume.
+///
+/// Used in the boundary scoring mode: only steps inside the detector reach
+/// user code, the particle is scored on its first one and then killed.
+
+class DetectorSD : public G4VSensitiveDetector
+{
+public:
+	DetectorSD(const G4String& name, RunAction* runAction);
+	~DetectorSD() override = default;
+
+	G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+
+private:
+	RunAction* fRunAction{ nullptr };
+};
+
+#endif // !DetectorSD_h
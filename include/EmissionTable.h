@@ -0,0 +1,133 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/EmissionTable.h
+/// \brief Definition of the EmissionTable class
+
+#pragma once
+
+#ifndef EmissionTable_h
+#define EmissionTable_h
+
+#include "AliasTable.h"
+#include "globals.hh"
+#include <memory>
+#include <vector>
+
+class G4ParticleDefinition;
+
+/// Tabulated emissions of a radioactive nuclide.
+///
+/// The table is computed from complete decays of the nuclide at rest,
+/// including the decays of its daughters as in the transport (down to the
+/// very long decay time threshold), sampled with the radioactive decay
+/// process of Geant4 without any tracking.
+/// The emissions of fixed energy (gamma and X-ray lines, alphas,
+/// conversion and Auger electrons) are kept exact: the decays emitting the
+/// same lines share one entry, sampled by its intensity with an alias
+/// table. The beta particles and their neutrinos have continuous
+/// energies: each entry keeps the binned spectrum of its beta particles,
+/// sampled anew at each decay (alias table of the bins, uniform within a
+/// bin), and the neutrino of a beta particle takes the energy it leaves.
+/// The intensities and spectra still carry the statistical error of the
+/// tabulated decays, which a run should not outnumber by far.
+/// The table is cached on disk, with a header identifying the Geant4
+/// version, decay data and radioactive decay settings (nucleus limits and
+/// volumes) it was computed with. Radioactive decays restricted to some
+/// volumes are not tabulated.
+/// The tables are meant to be got by the master before the run (see
+/// PrimaryGeneratorAction::PrepareRun), the worker threads then find them
+/// in memory; the decays are sampled with a dedicated engine.
+
+class EmissionTable
+{
+public:
+	struct Emission
+	{
+		const G4ParticleDefinition* particle{ nullptr };
+		G4int pdg{ 0 };
+		G4double ekin{ 0.0 };
+	};
+
+	using Decay = std::vector<Emission>;
+
+	/// Directory of the cached tables, set once by main (none by default:
+	/// the tables are then tabulated by every job)
+	static void SetCacheDirectory(const G4String& directory);
+
+	/// Shared table of a nuclide, loaded from the cache directory or
+	/// tabulated with nbOfDecays decays and stored there; null when the
+	/// nuclide cannot be tabulated
+	static std::shared_ptr<const EmissionTable> Get(G4int Z, G4int A, G4double excitation,
+		G4int nbOfDecays);
+
+	/// Emissions of one decay, sampled with the engine of the thread
+	void Sample(Decay& decay) const;
+
+	std::size_t GetNbOfEntries() const { return fEntries.size(); }
+	G4int GetNbOfDecays() const { return fNbOfDecays; }
+
+private:
+	// Bins of the beta spectra, from 0 to the maximum tabulated energy
+	static constexpr G4int kNbOfBins = 200;
+
+	// Emission of continuous energy of an entry: a binned spectrum, or
+	// for a neutrino the energy left by its beta particle (partner)
+	struct Continuum
+	{
+		const G4ParticleDefinition* particle{ nullptr };
+		G4int pdg{ 0 };
+		G4int partner{ -1 };
+		G4double sharedEnergy{ 0.0 };
+		G4double maxEnergy{ 0.0 };
+		std::vector<G4double> counts;
+		AliasTable aliasTable;
+	};
+
+	struct Entry
+	{
+		Decay lines;
+		std::vector<Continuum> continua;
+	};
+
+	EmissionTable(G4int Z, G4int A, G4double excitation, G4int nbOfDecays);
+
+	G4String GetHeader() const;
+	G4bool Load(const G4String& fileName);
+	void Save(const G4String& fileName) const;
+	G4bool Tabulate();
+
+	G4int fZ{ 0 };
+	G4int fA{ 0 };
+	G4double fExcitation{ 0.0 };
+	G4int fNbOfDecays{ 0 };
+
+	std::vector<Entry> fEntries;
+	std::vector<G4double> fCounts;
+	AliasTable fAliasTable;
+};
+
+#endif // !EmissionTable_h
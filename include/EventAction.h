@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/EventAction.h
+/// \brief Definition of the EventAction class
+
+#pragma once
+
+#ifndef EventAction_h
+#define EventAction_h
+
+#include "G4UserEventAction.hh"
+
+class RunAction;
+
+/// Event action class.
+///
+/// It passes the event boundaries to the run action, which publishes its
+/// spectra to the convergence monitor at regular checkpoints and tags the
+/// phase space records with the event ID.
+
+class EventAction : public G4UserEventAction
+{
+public:
+	EventAction(RunAction* runAction);
+	~EventAction() override = default;
+
+	void BeginOfEventAction(const G4Event* event) override;
+	void EndOfEventAction(const G4Event* event) override;
+
+private:
+	RunAction* fRunAction{ nullptr };
+};
+
+#endif // !EventAction_h
@@ -0,0 +1,124 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/HistoBuffer.h
+/// \brief Definition of the HistoBuffer class
+
+#pragma once
+
+#ifndef HistoBuffer_h
+#define HistoBuffer_h
+
+#include "globals.hh"
+#include <vector>
+
+namespace tools {
+namespace histo {
+class h1d;
+}
+}
+
+/// Thread-local fixed-bin buffer of one spectrum.
+///
+/// It is configured from an analysis manager histogram at begin of run,
+/// filled with a plain index computation and flushed into the histogram
+/// (entries, sum of weights, of squared weights and the x moments) at end
+/// of run or at a checkpoint. Index 0 and nbins+1 hold the underflow and
+/// the overflow as in the tools histograms.
+/// The squared weights are those of the histories: the weights of the
+/// particles of an event are summed per bin and the sum is squared at
+/// EndOfEvent, so that correlated particles (secondaries of a split,
+/// cascades of one decay) are not counted as independent samples.
+
+class alignas(64) HistoBuffer
+{
+public:
+	struct Bin
+	{
+		G4double entries{ 0.0 };
+		G4double sw{ 0.0 };
+		G4double sw2{ 0.0 };
+		G4double sxw{ 0.0 };
+		G4double sx2w{ 0.0 };
+	};
+
+	HistoBuffer() = default;
+	~HistoBuffer() = default;
+
+	/// Takes the binning of h1; returns false if it is not fixed-bin,
+	/// or if the value transformation cannot be reproduced here
+	G4bool Configure(const tools::histo::h1d* h1, G4double unit, G4bool identityFcn);
+	void Reset();
+	void FlushTo(tools::histo::h1d* h1);
+
+	inline void Fill(G4double x, G4double weight = 1.0);
+
+	/// Closes the history, returns the sum of its weights in range
+	G4double EndOfEvent();
+
+	G4int GetNbins() const { return fNbins; }
+	const std::vector<Bin>& GetBins() const { return fBins; }
+
+private:
+	G4double fXmin{ 0.0 };
+	G4double fXmax{ 0.0 };
+	G4double fInvWidth{ 0.0 };
+	G4double fInvUnit{ 1.0 };
+	G4int fNbins{ 0 };
+
+	std::vector<Bin> fBins;
+
+	// Sums of the weights of the open history and the bins it touched
+	std::vector<G4double> fEventSw;
+	std::vector<std::size_t> fTouched;
+};
+
+inline void HistoBuffer::Fill(G4double x, G4double weight)
+{
+	G4double u = x * fInvUnit;
+
+	std::size_t ibin = 0;
+	if (u >= fXmax)
+	{
+		ibin = fNbins + 1;
+	}
+	else if (u >= fXmin)
+	{
+		ibin = 1 + static_cast<std::size_t>((u - fXmin) * fInvWidth);
+		if (ibin > static_cast<std::size_t>(fNbins)) ibin = fNbins;
+	}
+
+	auto& bin = fBins[ibin];
+	bin.entries += 1.0;
+	bin.sw += weight;
+	bin.sxw += u * weight;
+	bin.sx2w += u * u * weight;
+
+	if (fEventSw[ibin] == 0.0) fTouched.push_back(ibin);
+	fEventSw[ibin] += weight;
+}
+
+#endif // !HistoBuffer_h
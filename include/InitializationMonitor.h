@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/InitializationMonitor.h
+/// \brief Definition of the InitializationMonitor class
+
+#pragma once
+
+#ifndef InitializationMonitor_h
+#define InitializationMonitor_h
+
+#include "G4VStateDependent.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+
+/// Reports the cost of the initialization of the master thread.
+///
+/// It follows the application states: the kernel initialization
+/// (/run/initialize) and the initialization of the first run, where the
+/// physics tables are built, are timed; the resident memory is printed
+/// after each of them and at the end of the first run, when the worker
+/// threads have built their own tables.
+/// The state changes seen here are those of the master only: the worker
+/// threads time their own initialization, from the creation of their
+/// run action to their first begin of run, and report it with
+/// AddWorkerInitTime; the slowest of them is kept.
+
+class InitializationMonitor : public G4VStateDependent
+{
+public:
+	InitializationMonitor(const G4String& physicsListName);
+	~InitializationMonitor() override = default;
+
+	G4bool Notify(G4ApplicationState requestedState) override;
+
+	/// Resident and peak resident memory of the process in bytes, 0 if unknown
+	static std::size_t GetResidentMemory();
+	static std::size_t GetPeakMemory();
+
+	/// Real times of the kernel and first run initializations in seconds,
+	/// 0 until they are done
+	static G4double GetKernelInitTime() { return fKernelInitTime; }
+	static G4double GetRunInitTime() { return fRunInitTime; }
+
+	/// Real time of the initialization of a worker thread in seconds;
+	/// the largest one is returned, 0 without worker threads
+	static void AddWorkerInitTime(G4double time);
+	static G4double GetWorkerInitTime();
+
+private:
+	void Report(const char* step, G4bool timed) const;
+
+	static G4double fKernelInitTime;
+	static G4double fRunInitTime;
+	static G4double fWorkerInitTime;
+	static G4Mutex fWorkerMutex;
+
+	G4String fPhysicsListName;
+	G4Timer fTimer;
+	G4int fNbOfInits{ 0 };
+	G4bool fRunReported{ false };
+};
+
+#endif // !InitializationMonitor_h
@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/IsotopeSource.h
+/// \brief Definition of the IsotopeSource class
+
+#pragma once
+
+#ifndef IsotopeSource_h
+#define IsotopeSource_h
+
+#include "AliasTable.h"
+#include "EmissionTable.h"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+#include <memory>
+#include <vector>
+
+class G4Event;
+class G4ParticleDefinition;
+class IsotopeSourceMessenger;
+
+/// Radioactive source made of a mixture of nuclides at rest, as a light
+/// replacement of the general particle source for isotope sources.
+///
+/// The source is a point, a disk normal to z or a cylinder along z. The
+/// nuclide of each event is sampled from the activities with an alias
+/// table, and either emitted as an ion or, with emission tables, replaced
+/// by the particles of one of its tabulated decays. All tables are built
+/// at begin of run by Prepare, by the master first so that the emission
+/// tables are tabulated once and outside the events; the events then
+/// sample them without any allocation beyond the primaries.
+
+class IsotopeSource
+{
+public:
+	enum Shape { kPoint, kDisk, kCylinder };
+
+	IsotopeSource();
+	~IsotopeSource();
+
+	/// Ions, emission tables and nuclide table of the run
+	void Prepare();
+	void GeneratePrimaryVertex(G4Event* anEvent);
+
+	void SetShape(Shape shape) { fShape = shape; }
+	void SetCentre(const G4ThreeVector& centre) { fCentre = centre; }
+	void SetRadius(G4double radius) { fRadius = radius; }
+	void SetHalfLength(G4double halfLength) { fHalfLength = halfLength; }
+	void AddNuclide(G4int Z, G4int A, G4double activity, G4double excitation);
+	void ClearNuclides();
+	void SetEmissionTables(G4bool value) { fEmissionTables = value; fPrepared = false; }
+	G4bool GetEmissionTables() const { return fEmissionTables; }
+	void SetNbOfTabulatedDecays(G4int nb) { fNbOfTabulatedDecays = nb; fPrepared = false; }
+
+private:
+	struct Nuclide
+	{
+		G4int Z{ 0 };
+		G4int A{ 0 };
+		G4double activity{ 0.0 };
+		G4double excitation{ 0.0 };
+		G4ParticleDefinition* ion{ nullptr };
+		std::shared_ptr<const EmissionTable> emissionTable;
+	};
+
+	G4ThreeVector SamplePosition() const;
+
+	IsotopeSourceMessenger* fMessenger{ nullptr };
+
+	Shape fShape{ kPoint };
+	G4ThreeVector fCentre;
+	G4double fRadius{ 0.0 };
+	G4double fHalfLength{ 0.0 };
+	G4bool fEmissionTables{ false };
+	G4int fNbOfTabulatedDecays{ 1000000 };
+
+	std::vector<Nuclide> fNuclides;
+	AliasTable fNuclideTable;
+	EmissionTable::Decay fDecay;
+	G4bool fPrepared{ false };
+};
+
+#endif // !IsotopeSource_h
@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/IsotopeSourceMessenger.h
+/// \brief Definition of the IsotopeSourceMessenger class
+
+#pragma once
+
+#ifndef IsotopeSourceMessenger_h
+#define IsotopeSourceMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWith3VectorAndUnit;
+
+class IsotopeSource;
+
+/// Messenger class that defines commands for IsotopeSource.
+///
+/// It implements commands:
+/// - /src/iso/shape point|disk|cylinder
+/// - /src/iso/centre x y z unit
+/// - /src/iso/radius value unit
+/// - /src/iso/halfLength value unit
+/// - /src/iso/addNuclide Z A activity [excitation unit]
+/// - /src/iso/clearNuclides
+/// - /src/iso/emissionTables bool
+
+class IsotopeSourceMessenger : public G4UImessenger
+{
+public:
+	IsotopeSourceMessenger(IsotopeSource* source);
+	~IsotopeSourceMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	IsotopeSource* fSource{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcmdWithAString* fShapeCmd{ nullptr };
+	G4UIcmdWith3VectorAndUnit* fCentreCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fRadiusCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fHalfLengthCmd{ nullptr };
+	G4UIcommand* fAddNuclideCmd{ nullptr };
+	G4UIcmdWithoutParameter* fClearNuclidesCmd{ nullptr };
+	G4UIcmdWithABool* fEmissionTablesCmd{ nullptr };
+};
+
+#endif // !IsotopeSourceMessenger_h
@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/PhaseSpaceReader.h
+/// \brief Definition of the PhaseSpaceReader class
+
+#pragma once
+
+#ifndef PhaseSpaceReader_h
+#define PhaseSpaceReader_h
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include "G4Threading.hh"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Shared reader of phase space files written by PhaseSpaceWriter.
+///
+/// The files are memory mapped and indexed by block when opened; the
+/// threads then take the blocks one after the other and decode them on
+/// their own. As the writer closes its blocks at event boundaries, the
+/// records of an event are always in the same block.
+/// The histories of the blocks taken in a run are summed: a replay is
+/// normalized to the events of the recording run, not to its own events
+/// (which are multiplied by the recycling). A run taking all the blocks
+/// gets all the histories of the files, including those of the files
+/// (e.g. of threads behind thick shields) which recorded no block.
+
+class PhaseSpaceReader
+{
+public:
+	struct Record
+	{
+		G4int pdg{ 0 };
+		G4double ekin{ 0.0 };
+		G4ThreeVector position;
+		G4ThreeVector direction;
+		G4double weight{ 1.0 };
+		G4int eventID{ 0 };
+		G4double time{ 0.0 };
+	};
+
+	static PhaseSpaceReader* Instance();
+
+	/// Maps and indexes the files, unless they are already open
+	G4bool Open(const std::vector<G4String>& fileNames);
+
+	/// Decodes the next block of the run into records, false once all
+	/// blocks were taken (the blocks are taken again from the first one
+	/// in each new run)
+	G4bool NextBlock(G4int runID, std::vector<Record>& records);
+
+	std::size_t GetNbOfBlocks() const { return fBlocks.size(); }
+
+	/// Histories of the blocks taken in the run (of the files once all the
+	/// blocks were taken, complete being then set), -1 if the run
+	/// replayed no block or if a file does not give its histories
+	G4long GetNbOfHistories(G4int runID, G4bool& complete) const;
+
+private:
+	struct MappedFile;
+	struct BlockRef
+	{
+		const unsigned char* data{ nullptr };
+		std::size_t size{ 0 };
+		std::uint32_t nbOfRecords{ 0 };
+		std::uint32_t nbOfHistories{ 0 };
+		std::size_t headerSize{ 4 };
+	};
+
+	PhaseSpaceReader();
+	~PhaseSpaceReader();
+
+	G4bool Index(const MappedFile& file, G4bool& withHistories);
+	G4bool Decode(const BlockRef& block, std::vector<Record>& records) const;
+
+	mutable G4Mutex fMutex = G4MUTEX_INITIALIZER;
+	std::vector<G4String> fFileNames;
+	std::vector<std::unique_ptr<MappedFile>> fFiles;
+	std::vector<BlockRef> fBlocks;
+	std::size_t fNextBlock{ 0 };
+	G4int fRunID{ -1 };
+	G4bool fWithHistories{ true };
+	G4long fNbOfHistories{ 0 };
+	G4long fTotalHistories{ 0 };
+};
+
+#endif // !PhaseSpaceReader_h
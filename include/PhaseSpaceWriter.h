@@ -0,0 +1,150 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/PhaseSpaceWriter.h
+/// \brief Definition of the PhaseSpaceWriter class
+
+#pragma once
+
+#ifndef PhaseSpaceWriter_h
+#define PhaseSpaceWriter_h
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <vector>
+
+class PhaseSpaceMessenger;
+
+/// Thread-local phase space stream of the particles entering the detector,
+/// or crossing a plane (the exit face of the absorber stack or a given z),
+/// where they are then killed: the file can be replayed as the source of
+/// later runs (PrimaryGeneratorAction).
+///
+/// The records are accumulated column by column and, once a block is full,
+/// handed at the next event boundary to an asynchronous task which
+/// compresses and writes it while the thread goes on simulating (one block
+/// in flight at most, so the blocks stay in order).
+///
+/// File layout (little endian):
+/// - header: "ABSPHSP2", uint32 number of columns, uint32 flags
+///   (bit 0: zlib available to the writer)
+/// - blocks: uint32 number of records, uint32 number of histories (the
+///   events simulated since the previous block, with or without records),
+///   then for each column uint32 raw size and uint32 stored size followed
+///   by the stored bytes; the stored bytes are zlib compressed when
+///   smaller than the raw ones
+/// - end: a block of 0 records, with the histories after the last block
+/// The histories are what a replay of the file is normalized to.
+/// Files of the former "ABSPHSP1" layout have no number of histories.
+/// The columns are, in this order: pdg (int32), ekin (float, MeV),
+/// x, y, z (float, mm), dx, dy, dz (float), weight (double), event
+/// (int32, difference to the previous record of the block) and time
+/// (double, ns).
+/// The bytes of the multi-byte values are grouped by significance
+/// (byte shuffle) before compression.
+
+class PhaseSpaceWriter
+{
+public:
+	static constexpr std::uint32_t kNbOfColumns = 11;
+
+	enum PlaneMode { kDetectorEntry, kStackExit, kPlaneZ };
+
+	PhaseSpaceWriter();
+	~PhaseSpaceWriter();
+
+	void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+	G4bool IsEnabled() const { return fEnabled; }
+	void SetBlockSize(G4int size) { fBlockSize = size; }
+	void SetCompressionLevel(G4int level) { fCompressionLevel = level; }
+	void SetPlaneMode(PlaneMode mode) { fPlaneMode = mode; }
+	PlaneMode GetPlaneMode() const { return fPlaneMode; }
+	void SetPlaneZ(G4double z) { fPlaneZ = z; fPlaneMode = kPlaneZ; }
+	G4double GetPlaneZ() const { return fPlaneZ; }
+
+	G4bool Open(const G4String& fileName);
+	void Close();
+	G4bool IsOpen() const { return fFile.is_open(); }
+
+	inline void Fill(G4int pdg, G4double ekin, const G4ThreeVector& position,
+		const G4ThreeVector& direction, G4double weight, G4int eventID, G4double time);
+
+	/// Counts the history and submits the current block if it is full
+	void EndOfEvent();
+
+private:
+	struct Block
+	{
+		std::vector<std::int32_t> pdg;
+		std::vector<float> ekin, x, y, z, dx, dy, dz;
+		std::vector<double> weight;
+		std::vector<std::int32_t> event;
+		std::vector<double> time;
+		std::uint32_t nbOfHistories{ 0 };
+
+		std::size_t size() const { return pdg.size(); }
+		void reserve(std::size_t n);
+	};
+
+	void Submit();
+	void WriteBlock(const Block& block);
+	void WriteColumn(const void* data, std::size_t count, std::size_t typeSize);
+
+	PhaseSpaceMessenger* fMessenger{ nullptr };
+
+	G4bool fEnabled{ false };
+	G4int fBlockSize{ 65536 };
+	G4int fCompressionLevel{ 1 };
+	PlaneMode fPlaneMode{ kDetectorEntry };
+	G4double fPlaneZ{ 0.0 };
+
+	std::ofstream fFile;
+	Block fBlock;
+	G4int fLastEventID{ 0 };
+	std::future<void> fPending;
+};
+
+inline void PhaseSpaceWriter::Fill(G4int pdg, G4double ekin, const G4ThreeVector& position,
+	const G4ThreeVector& direction, G4double weight, G4int eventID, G4double time)
+{
+	fBlock.pdg.push_back(pdg);
+	fBlock.ekin.push_back(static_cast<float>(ekin));
+	fBlock.x.push_back(static_cast<float>(position.x()));
+	fBlock.y.push_back(static_cast<float>(position.y()));
+	fBlock.z.push_back(static_cast<float>(position.z()));
+	fBlock.dx.push_back(static_cast<float>(direction.x()));
+	fBlock.dy.push_back(static_cast<float>(direction.y()));
+	fBlock.dz.push_back(static_cast<float>(direction.z()));
+	fBlock.weight.push_back(weight);
+	fBlock.event.push_back(eventID - fLastEventID);
+	fBlock.time.push_back(time);
+	fLastEventID = eventID;
+}
+
+#endif // !PhaseSpaceWriter_h
@@ -0,0 +1,54 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/PhysicsList.h
+/// \brief Definition of the PhysicsList class
+
+#pragma once
+
+#ifndef PhysicsList_h
+#define PhysicsList_h
+
+#include "G4VModularPhysicsList.hh"
+
+/// Lean physics list for the decay spectroscopy runs.
+///
+/// Only what the radioactive sources need at keV-MeV energies: the
+/// standard electromagnetic physics with the low energy models (option 4),
+/// the decay of the unstable particles and the radioactive decay.
+/// The step limiter and special cuts processes apply the user limits
+/// set on the absorbers; with fastSimulation, the photons reach the fast
+/// simulation models of the absorber regions.
+/// No hadronic tables are built.
+
+class PhysicsList : public G4VModularPhysicsList
+{
+public:
+	PhysicsList(G4bool fastSimulation);
+	~PhysicsList() override = default;
+};
+
+#endif // !PhysicsList_h
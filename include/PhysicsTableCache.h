@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/PhysicsTableCache.h
+/// \brief Definition of the PhysicsTableCache class
+
+#pragma once
+
+#ifndef PhysicsTableCache_h
+#define PhysicsTableCache_h
+
+#include "G4VStateDependent.hh"
+
+/// Persistent cache of the physics tables.
+///
+/// Before each run initialization, a key is made of the Geant4 version,
+/// the physics list, the production cuts of all regions and the material
+/// table. If the cache directory holds tables stored under the same key,
+/// the physics list retrieves them instead of building them; otherwise
+/// the tables built for the run are stored there. The key description is
+/// written to a marker file, checked before any retrieval, and the tables
+/// are moved in place only once complete so that concurrent jobs sharing
+/// the cache never see a partial directory.
+/// Note that Geant4 stores the cuts and electromagnetic tables only.
+
+class PhysicsTableCache : public G4VStateDependent
+{
+public:
+	/// An empty directory disables the cache
+	PhysicsTableCache(const G4String& directory, const G4String& physicsListName);
+	~PhysicsTableCache() override = default;
+
+	G4bool Notify(G4ApplicationState requestedState) override;
+
+private:
+	G4String MakeKey() const;
+	void Prepare();
+	void Store();
+
+	G4String fDirectory;
+	G4String fPhysicsListName;
+
+	G4String fKey;
+	G4String fTablesDirectory;
+	G4bool fStorePending{ false };
+};
+
+#endif // !PhysicsTableCache_h
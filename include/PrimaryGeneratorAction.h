@@ -33,21 +33,97 @@
 #define PrimaryGeneratorAction_h
 
 #include "G4VUserPrimaryGeneratorAction.hh"
+#include "PhaseSpaceReader.h"
+#include "EmissionTable.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 class G4GeneralParticleSource;
+class G4ParticleDefinition;
+class IsotopeSource;
+class PrimaryGeneratorMessenger;
 
 /// The primary generator action class with general particle source.
+///
+/// In the phase space mode, the primaries are read instead from phase
+/// space files: each event replays the records of one recorded event,
+/// optionally several times (with the weights divided accordingly) and
+/// rotated by a random angle around the z axis of the setup.
+///
+/// In the emission table mode, the ion of the general particle source is
+/// not tracked: each event directly emits, isotropically from a position
+/// of the source, the particles of one decay sampled from the emission
+/// table of the ion.
+///
+/// The isotope source mode replaces the general particle source by the
+/// lighter IsotopeSource (/src/iso/ commands).
+///
+/// The beam mode sends a pencil beam along the z axis, with energies
+/// uniform in a range, without changing the general particle source.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
 public:
+	enum SourceMode { kGeneralParticleSource, kPhaseSpace, kEmissionTable, kIsotopeSource, kBeam };
+
 	PrimaryGeneratorAction();
 	~PrimaryGeneratorAction() override;
 
 	void GeneratePrimaries(G4Event* anEvent) override;
 
+	/// Tables of the run, called at begin of run by the run action: by
+	/// the master first (with its own instance in MT), before any event
+	void PrepareRun();
+
+	void SetSourceMode(SourceMode mode) { fSourceMode = mode; }
+	SourceMode GetSourceMode() const { return fSourceMode; }
+	void AddPhaseSpaceFile(const G4String& fileName) { fFileNames.push_back(fileName); }
+	void ClearPhaseSpaceFiles() { fFileNames.clear(); }
+	void SetRecycling(G4int nb) { fRecycling = nb; }
+	void SetRotation(G4bool rotate) { fRotation = rotate; }
+	void SetNbOfTabulatedDecays(G4int nb);
+	void SetBeamParticle(const G4String& name);
+	void SetBeamEnergyRange(G4double minEnergy, G4double maxEnergy);
+	void SetBeamZ(G4double z) { fBeamZ = z; }
+
+	/// Whether the primaries of the current event are emitted isotropically
+	/// (and may be biased toward the detector): decay emissions and an
+	/// isotropic general particle source, not beams nor replays
+	G4bool HasIsotropicPrimaries() const { return fIsotropicPrimaries; }
+
 private:
+	void ReplayEvent(G4Event* anEvent);
+	void EmitDecay(G4Event* anEvent);
+	void GenerateBeam(G4Event* anEvent);
+	G4ParticleDefinition* GetParticle(G4int pdg);
+
 	G4GeneralParticleSource* fGPS{ nullptr };
+	IsotopeSource* fIsotopeSource{ nullptr };
+	PrimaryGeneratorMessenger* fMessenger{ nullptr };
+
+	SourceMode fSourceMode{ kGeneralParticleSource };
+	std::vector<G4String> fFileNames;
+	G4int fRecycling{ 1 };
+	G4bool fRotation{ false };
+	G4int fNbOfTabulatedDecays{ 1000000 };
+	G4bool fIsotropicPrimaries{ false };
+
+	G4ParticleDefinition* fBeamParticle{ nullptr };
+	G4double fBeamMinEnergy{ 0.0 };
+	G4double fBeamMaxEnergy{ 0.0 };
+	G4double fBeamZ{ 0.0 };
+
+	// Replay state of this thread
+	std::vector<PhaseSpaceReader::Record> fRecords;
+	std::size_t fNextRecord{ 0 };
+	G4int fRepeat{ 0 };
+	G4int fRunID{ -1 };
+	std::unordered_map<G4int, G4ParticleDefinition*> fParticles;
+
+	// Emission table of the current run, and the decay sampled from it
+	std::shared_ptr<const EmissionTable> fEmissionTable;
+	EmissionTable::Decay fDecay;
 };
 
 #endif // !PrimaryGeneratorAction_h
@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/PrimaryGeneratorMessenger.h
+/// \brief Definition of the PrimaryGeneratorMessenger class
+
+#pragma once
+
+#ifndef PrimaryGeneratorMessenger_h
+#define PrimaryGeneratorMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+class PrimaryGeneratorAction;
+
+/// Messenger class that defines commands for PrimaryGeneratorAction.
+///
+/// It implements commands:
+/// - /src/mode gps|phsp|emission|iso|beam
+/// - /src/addFile fileName
+/// - /src/clearFiles
+/// - /src/recycle nb
+/// - /src/rotate bool
+/// - /src/tabulatedDecays nb
+/// - /src/beam/particle name
+/// - /src/beam/energy min max unit
+/// - /src/beam/z value unit
+
+class PrimaryGeneratorMessenger : public G4UImessenger
+{
+public:
+	PrimaryGeneratorMessenger(PrimaryGeneratorAction* action);
+	~PrimaryGeneratorMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+	G4String GetCurrentValue(G4UIcommand* command) override;
+
+private:
+	PrimaryGeneratorAction* fAction{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcmdWithAString* fModeCmd{ nullptr };
+	G4UIcmdWithAString* fAddFileCmd{ nullptr };
+	G4UIcmdWithoutParameter* fClearFilesCmd{ nullptr };
+	G4UIcmdWithAnInteger* fRecycleCmd{ nullptr };
+	G4UIcmdWithABool* fRotateCmd{ nullptr };
+	G4UIcmdWithAnInteger* fTabulatedDecaysCmd{ nullptr };
+
+	G4UIdirectory* fBeamDirectory{ nullptr };
+	G4UIcmdWithAString* fBeamParticleCmd{ nullptr };
+	G4UIcommand* fBeamEnergyCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fBeamZCmd{ nullptr };
+};
+
+#endif // !PrimaryGeneratorMessenger_h
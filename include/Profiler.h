@@ -0,0 +1,125 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/Profiler.h
+/// \brief Definition of the Profiler class
+
+#pragma once
+
+#ifndef Profiler_h
+#define Profiler_h
+
+#include "globals.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include <chrono>
+#include <unordered_map>
+
+class ProfilerMessenger;
+
+/// Thread-local step and time profiler (/prof/ commands).
+///
+/// When enabled, the stepping action hands it every step: the number of
+/// steps and the wall time since the previous step of the thread are
+/// accumulated per physical volume (of the pre-step point), per particle
+/// and per process (limiting the step), and the tracks are counted at
+/// their first step per volume of origin, particle and creator process.
+/// At end of run each thread merges its counters by name; the master
+/// prints the merged tables and writes them to <analysis file>_profile.csv.
+
+class Profiler
+{
+public:
+	enum Category { kVolume, kParticle, kProcess, kNbOfCategories };
+
+	struct Counters
+	{
+		G4long steps{ 0 };
+		G4long tracks{ 0 };
+		G4double time{ 0.0 };
+	};
+
+	Profiler();
+	~Profiler();
+
+	void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+	G4bool IsEnabled() const { return fEnabled; }
+	void SetNbOfRows(G4int nb) { fNbOfRows = nb; }
+
+	void BeginOfRun();
+	void BeginOfEvent() { fLastTime = Clock::now(); }
+	inline void Step(const G4Step* step);
+
+	/// Adds the counters of this thread to the merged ones
+	void Merge();
+
+	/// Prints and writes the merged counters, then clears them (master)
+	void Report(const G4String& fileName);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	ProfilerMessenger* fMessenger{ nullptr };
+	G4bool fEnabled{ false };
+	G4int fNbOfRows{ 20 };
+
+	Clock::time_point fLastTime;
+	std::unordered_map<const void*, Counters> fCounters[kNbOfCategories];
+};
+
+inline void Profiler::Step(const G4Step* step)
+{
+	auto now = Clock::now();
+	G4double time = std::chrono::duration<G4double>(now - fLastTime).count();
+	fLastTime = now;
+
+	auto track = step->GetTrack();
+	auto newTrack = track->GetCurrentStepNumber() == 1;
+	auto process = step->GetPostStepPoint()->GetProcessDefinedStep();
+
+	const void* keys[kNbOfCategories] =
+	{
+		step->GetPreStepPoint()->GetPhysicalVolume(),
+		track->GetDefinition(),
+		process
+	};
+
+	for (G4int i = 0; i < kNbOfCategories; i++)
+	{
+		auto& counters = fCounters[i][keys[i]];
+		counters.steps++;
+		counters.time += time;
+	}
+
+	if (newTrack)
+	{
+		fCounters[kVolume][keys[kVolume]].tracks++;
+		fCounters[kParticle][keys[kParticle]].tracks++;
+		fCounters[kProcess][track->GetCreatorProcess()].tracks++;
+	}
+}
+
+#endif // !Profiler_h
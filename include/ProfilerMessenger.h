@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ProfilerMessenger.h
+/// \brief Definition of the ProfilerMessenger class
+
+#pragma once
+
+#ifndef ProfilerMessenger_h
+#define ProfilerMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+
+class Profiler;
+
+/// Messenger class that defines commands for Profiler.
+///
+/// It implements commands:
+/// - /prof/enable bool
+/// - /prof/rows nb
+
+class ProfilerMessenger : public G4UImessenger
+{
+public:
+	ProfilerMessenger(Profiler* profiler);
+	~ProfilerMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	Profiler* fProfiler{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcmdWithABool* fEnableCmd{ nullptr };
+	G4UIcmdWithAnInteger* fRowsCmd{ nullptr };
+};
+
+#endif // !ProfilerMessenger_h
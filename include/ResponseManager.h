@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ResponseManager.h
+/// \brief Definition of the ResponseManager class
+
+#pragma once
+
+#ifndef ResponseManager_h
+#define ResponseManager_h
+
+#include "ResponseMatrix.h"
+#include "globals.hh"
+#include <map>
+#include <memory>
+#include <utility>
+
+class DetectorConstruction;
+class ResponseMessenger;
+
+/// Layer response matrices and their fast folding through stacks.
+///
+/// The response of a layer is computed with the existing geometry, as a
+/// stack of that single layer: for each simulated particle type and each
+/// energy bin, a pencil beam uniform in the bin (/src/mode beam) is sent
+/// along z onto the layer and the spectra leaving it through its exit face
+/// are read back from the run summary. The response of the detector is
+/// computed alike without absorber, scored as usual.
+/// These runs are unbiased: the stacking options, the phase space, the
+/// acceptance culling and the fast simulation are off; the absorber stack,
+/// the source mode, the spectra binning and the file name are restored
+/// afterwards.
+/// The matrices are kept in memory and cached on disk per material,
+/// thickness, binning and settings (physics list, cuts, user limits and
+/// geometry).
+/// The response runs of the photons also tabulate their transmission
+/// through the layer (see SlabTransmission), published for the fast
+/// simulation of the slabs.
+/// Stack candidates, read from a file, are then evaluated by folding the
+/// source spectra of a run summary (without absorbers, binned as the
+/// responses) through the responses of their layers, then once through the
+/// response of the detector, missing responses being computed on the way.
+
+class ResponseManager
+{
+public:
+	/// The matrices are cached in cacheDirectory, if not empty
+	ResponseManager(DetectorConstruction* det, const G4String& physicsListName,
+		const G4String& cacheDirectory);
+	~ResponseManager();
+
+	void SetEnergyBins(G4int nbOfBins, G4double maxEnergy);
+	void SetEventsPerBin(G4int nb) { fEventsPerBin = nb; }
+
+	/// Fraction of the e+ e- spectrum folded as positrons
+	void SetPositronFraction(G4double fraction) { fPositronFraction = fraction; }
+
+	/// Response of a layer, loaded or computed if not yet in memory
+	const ResponseMatrix* GetResponse(const G4String& material, G4double thickness);
+
+	/// Publish the transmission tables of the slabs simulated fast (see
+	/// SlabGammaModel), from their responses, for the next runs
+	void PrepareFastSimulation();
+
+	/// Fold the source spectra through every candidate of the stack file
+	/// (one per line: name material thickness unit ...) and write the
+	/// transmitted spectra to a CSV file
+	void Evaluate(const G4String& stackFileName, const G4String& sourceFileName,
+		const G4String& outputFileName);
+
+private:
+	/// Response of the detector, loaded or computed if not yet in memory
+	const ResponseMatrix* GetDetectorResponse();
+
+	/// Load or compute a response, of the detector if no material
+	std::unique_ptr<ResponseMatrix> MakeResponse(const G4String& material, G4double thickness);
+	void Compute(ResponseMatrix& response, const G4String& material, G4double thickness);
+	G4bool ReadSummary(const G4String& fileName, ResponseMatrix::Spectra& spectra) const;
+
+	/// Settings a response depends on besides its layer and binning
+	G4String GetSettings(const G4String& material, G4double thickness) const;
+	G4String GetCacheFileName(const G4String& name, G4double thickness, const G4String& settings) const;
+
+	DetectorConstruction* fDetConstruction{ nullptr };
+	ResponseMessenger* fMessenger{ nullptr };
+	G4String fPhysicsListName;
+	G4String fCacheDirectory;
+
+	G4int fNbOfBins{ 150 };
+	G4double fMaxEnergy{ 0.0 };
+	G4int fEventsPerBin{ 10000 };
+	G4double fPositronFraction{ 0.0 };
+
+	std::map<std::pair<G4String, G4long>, std::unique_ptr<ResponseMatrix>> fResponses;
+	std::unique_ptr<ResponseMatrix> fDetectorResponse;
+};
+
+#endif // !ResponseManager_h
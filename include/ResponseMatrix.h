@@ -0,0 +1,116 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ResponseMatrix.h
+/// \brief Definition of the ResponseMatrix class
+
+#pragma once
+
+#ifndef ResponseMatrix_h
+#define ResponseMatrix_h
+
+#include "RunAction.h"
+#include "SlabTransmission.h"
+#include "globals.hh"
+#include <array>
+#include <memory>
+#include <vector>
+
+/// Transmission response of one absorber layer.
+///
+/// For a particle of a simulated type entering the layer at normal
+/// incidence with an energy in bin i, the mean weight per primary of each
+/// scored type leaving the layer through its exit face in each energy bin
+/// j. The energy bins and the scored types are those of the RunAction
+/// spectra, with linear bins from 0; electrons and positrons are simulated
+/// separately, the given fraction of the e+ e- spectrum being folded as
+/// positrons. Neutrinos go through unchanged and ions are not transmitted.
+/// The responses of the layers of a stack are folded one after the other;
+/// the angular and lateral spreads are not carried from one layer to the
+/// next, so the result is an approximation meant to rank stack candidates.
+/// The same matrix holds the response of the detector to the particles
+/// entering it, applied once behind the stack.
+/// The photon runs also fill the transmission tables of the layer, for its
+/// fast simulation (see SlabTransmission).
+/// The matrix is cached on disk with a header identifying how it was made,
+/// including the settings (physics, cuts, geometry) it depends on.
+
+class ResponseMatrix
+{
+public:
+	/// Spectra indexed by the histogram slot of RunAction
+	using Spectra = std::array<std::vector<G4double>, RunAction::kMaxHisto>;
+
+	/// Particles entering the layer which are simulated, and
+	/// the slots they are scored in
+	static constexpr G4int kNbOfInputs = 4;
+	static constexpr std::array<const char*, kNbOfInputs> kInputParticles{ "e-", "e+", "gamma", "alpha" };
+	static constexpr std::array<G4int, kNbOfInputs> kInputSlots{ 1, 1, 3, 4 };
+
+	ResponseMatrix(const G4String& material, G4double thickness,
+		G4int nbOfBins, G4double maxEnergy, G4int nbOfEvents, const G4String& settings);
+
+	G4bool Load(const G4String& fileName);
+	void Save(const G4String& fileName) const;
+
+	/// Spectra behind the layer, per primary of the given input
+	/// in the given energy bin
+	void SetResponse(G4int input, G4int inBin, const Spectra& out);
+
+	/// Spectra behind the layer for the spectra in front of it, the
+	/// given fraction of the e+ e- spectrum being positrons
+	Spectra Fold(const Spectra& in, G4double positronFraction) const;
+
+	Spectra MakeSpectra() const;
+
+	/// Transmission of the photons, filled bin by bin by the photon runs
+	void SetTransmission(G4int inBin, const SlabTransmission::Tally& tally)
+	{ fTransmission->SetBin(inBin, tally); }
+	std::shared_ptr<const SlabTransmission> GetTransmission() const { return fTransmission; }
+
+	G4int GetNbOfBins() const { return fNbOfBins; }
+	G4double GetMaxEnergy() const { return fMaxEnergy; }
+
+private:
+	G4String GetHeader() const;
+	std::size_t GetIndex(G4int inBin, G4int outSlot, G4int outBin) const
+	{
+		return (inBin * RunAction::kMaxHisto + outSlot) * fNbOfBins + outBin;
+	}
+
+	G4String fMaterial;
+	G4double fThickness{ 0.0 };
+	G4int fNbOfBins{ 0 };
+	G4double fMaxEnergy{ 0.0 };
+	G4int fNbOfEvents{ 0 };
+	G4String fSettings;
+
+	// Per input: [input bin][output slot][output bin]
+	std::array<std::vector<G4double>, kNbOfInputs> fResponse;
+	std::shared_ptr<SlabTransmission> fTransmission;
+};
+
+#endif // !ResponseMatrix_h
@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ResponseMessenger.h
+/// \brief Definition of the ResponseMessenger class
+
+#pragma once
+
+#ifndef ResponseMessenger_h
+#define ResponseMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+
+class ResponseManager;
+
+/// Messenger class that defines commands for ResponseManager.
+///
+/// It implements commands:
+/// - /resp/setEnergyBins nb value unit
+/// - /resp/setEventsPerBin nb
+/// - /resp/setPositronFraction value
+/// - /resp/compute material value unit
+/// - /resp/evaluate stackFile sourceSummary outputFile
+/// - /resp/prepareFastSim
+
+class ResponseMessenger : public G4UImessenger
+{
+public:
+	ResponseMessenger(ResponseManager* manager);
+	~ResponseMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	ResponseManager* fResponseManager{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcommand* fEnergyBinsCmd{ nullptr };
+	G4UIcmdWithAnInteger* fEventsPerBinCmd{ nullptr };
+	G4UIcmdWithADouble* fPositronFractionCmd{ nullptr };
+	G4UIcommand* fComputeCmd{ nullptr };
+	G4UIcommand* fEvaluateCmd{ nullptr };
+	G4UIcommand* fPrepareFastSimCmd{ nullptr };
+};
+
+#endif // !ResponseMessenger_h
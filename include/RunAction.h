@@ -34,23 +34,207 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
+#include "G4AnalysisManager.hh"
+#include "G4Timer.hh"
+#include "HistoBuffer.h"
+#include "ConvergenceMonitor.h"
+#include "PhaseSpaceWriter.h"
+#include "Profiler.h"
+#include "RunTelemetry.h"
+#include "SlabTransmission.h"
+#include "G4Track.hh"
+#include <array>
+#include <unordered_map>
 #include <vector>
 
+class G4ParticleDefinition;
+class SteppingAction;
+class PrimaryGeneratorAction;
+class RunMessenger;
+
 /// Run action class
+///
+/// It also owns the per-thread lookup used on the scoring hot path:
+/// particle definition -> histogram slot (0 = not scored), and the
+/// activation of each histogram, both refreshed at begin of run.
+/// Active spectra are filled into thread-local buffers which are
+/// flushed into the analysis manager histograms at end of run.
+/// Scoring is weighted: sums of weights and of squared weights are kept
+/// per bin and for the kinetic energy totals, and the master reports the
+/// relative errors and the figure of merit of each spectrum. The squares
+/// are taken per history (the sums of an event), the errors of spectra
+/// which cannot be buffered are estimated per particle.
+/// With precision targets set, the spectra totals are published to the
+/// ConvergenceMonitor every check interval events, which stops the run
+/// once the targets are met.
+/// At the end of each run the master also writes a text summary of the
+/// spectra and of the kinetic energy totals, with the shard metadata,
+/// which absorber_merge sums over the shards of a campaign.
+/// The particles entering the detector can also be recorded one by one
+/// to a thread-local PhaseSpaceWriter (/phsp/ commands).
+/// The thread-local Profiler (/prof/ commands) is fed by the stepping
+/// action, merged at end of run and reported by the master, as are
+/// the throughput counters of RunTelemetry.
+/// In the response runs of the photons, the transmission tally of the
+/// thread (filled by the stepping action) is merged at end of run.
 
 class RunAction : public G4UserRunAction
 {
 public:
+	static constexpr G4int kMaxHisto = 6;
+
 	RunAction();
-	~RunAction() override = default;
+	~RunAction() override;
 
 	void BeginOfRunAction(const G4Run* aRun) override;
 	void EndOfRunAction(const G4Run* aRun) override;
 
-	void AddEkin(G4int, G4double ekin);
+	/// Stepping action of this thread, registered by the caller; at begin
+	/// of run it is unregistered when the run does not need it (and owned
+	/// by the run action meanwhile)
+	void SetSteppingAction(SteppingAction* action) { fSteppingAction = action; }
+
+	/// Generator prepared at begin of run; the master owns its instance,
+	/// which only follows the source commands
+	void SetPrimaryGenerator(PrimaryGeneratorAction* action, G4bool owned = false)
+	{ fPrimaryGenerator = action; fOwnsPrimaryGenerator = owned; }
+
+	/// Directory of the analysis files, set once before the run manager
+	/// initialization (empty: the working directory)
+	static void SetOutputDirectory(const G4String& dir) { fOutputDirectory = dir; }
+
+	/// Shard of a sharded campaign (count 0: not sharded) and its seeds,
+	/// written to the run summary and appended to the analysis file name
+	static void SetShard(G4int index, G4int count, G4long baseSeed, G4long seed);
+
+	inline G4int GetSlot(const G4ParticleDefinition* particle);
+	inline void Score(G4int ih, G4double ekin, G4double weight);
+	inline void Record(const G4Track* track, const G4StepPoint* point);
+	inline void RecordAt(const G4Track* track, const G4StepPoint* point,
+		const G4ThreeVector& position);
+	inline void RecordAt(const G4Track* track, const G4ThreeVector& position, G4double time);
+
+	const PhaseSpaceWriter* GetPhaseSpace() const { return fPhaseSpace; }
+	Profiler* GetProfiler() const { return fProfiler; }
+	RunTelemetry& GetTelemetry() { return fTelemetry; }
+	SlabTransmission::Tally* GetTransmissionTally() { return &fTransmissionTally; }
+
+	void FlushHistograms();
+	void SetVerboseLevel(G4int level) { fVerboseLevel = level; }
+
+	void BeginOfEvent(G4int eventID);
+	void EndOfEvent();
+
+	void SetTargetRelError(G4int ih, G4double value) { fTargets.relError.at(ih) = value; }
+	void SetTargetBinRelError(G4int ih, G4double value) { fTargets.binRelError.at(ih) = value; }
+	void SetTargetEntries(G4int ih, G4double value) { fTargets.entries.at(ih) = value; }
+	void SetMinEvents(G4int nb) { fTargets.minEvents = nb; }
+	void SetCheckInterval(G4int nb) { fTargets.checkInterval = nb; }
+	void ClearTargets();
 
 private:
+	void Checkpoint();
+	void PrintStatistics(G4double time) const;
+	G4double GetSum2(G4int ih, const tools::histo::h1d* h1) const;
+	void WriteSummary(G4long nofEvents) const;
+	G4long GetNbOfHistories(const G4Run* aRun) const;
+	G4String GetOutputFileName(const G4String& fileName) const;
+	G4int ClassifyParticle(const G4ParticleDefinition* particle);
+	G4bool ConfigureBuffer(G4int ih);
+
+	static G4String fOutputDirectory;
+	static G4int fShardIndex;
+	static G4int fShardCount;
+	static G4long fBaseSeed;
+	static G4long fSeed;
+
+	RunMessenger* fMessenger{ nullptr };
+	G4int fVerboseLevel{ 1 };
+	G4Timer fTimer;
+
+	// Weighted kinetic energy totals and the sums of their squares,
+	// and the sums of the squared weights in range of the spectra
 	std::vector<G4Accumulable<G4double>> fEkin{ 0.0,0.0,0.0,0.0,0.0,0.0 };
+	std::vector<G4Accumulable<G4double>> fEkin2{ 0.0,0.0,0.0,0.0,0.0,0.0 };
+	std::vector<G4Accumulable<G4double>> fSum2{ 0.0,0.0,0.0,0.0,0.0,0.0 };
+
+	// Totals of the open history
+	std::array<G4double, kMaxHisto> fEventEkin{};
+
+	// Initialization of a worker thread, up to its first run
+	G4Timer fInitTimer;
+	G4bool fInitTimed{ false };
+
+	G4AnalysisManager* fAnalysisManager{ nullptr };
+	std::array<G4bool, kMaxHisto> fActive{};
+	std::array<G4bool, kMaxHisto> fBuffered{};
+	std::array<HistoBuffer, kMaxHisto> fBuffers;
+	std::unordered_map<const G4ParticleDefinition*, G4int> fSlots;
+	const G4ParticleDefinition* fLastParticle{ nullptr };
+	G4int fLastSlot{ 0 };
+
+	SteppingAction* fSteppingAction{ nullptr };
+	G4bool fSteppingActionRegistered{ true };
+	PrimaryGeneratorAction* fPrimaryGenerator{ nullptr };
+	G4bool fOwnsPrimaryGenerator{ false };
+
+	ConvergenceMonitor::Targets fTargets;
+	ConvergenceMonitor::Contribution fContribution;
+	G4int fMonitorSlot{ -1 };
+	G4int fNofEvents{ 0 };
+
+	PhaseSpaceWriter* fPhaseSpace{ nullptr };
+	G4bool fRecordDetectorEntry{ true };
+	G4int fEventID{ 0 };
+
+	Profiler* fProfiler{ nullptr };
+	RunTelemetry fTelemetry;
+	SlabTransmission::Tally fTransmissionTally;
 };
 
+inline G4int RunAction::GetSlot(const G4ParticleDefinition* particle)
+{
+	if (particle == fLastParticle) return fLastSlot;
+
+	auto it = fSlots.find(particle);
+	fLastSlot = (it != fSlots.end()) ? it->second : ClassifyParticle(particle);
+	fLastParticle = particle;
+	return fLastSlot;
+}
+
+inline void RunAction::Score(G4int ih, G4double ekin, G4double weight)
+{
+	if (fActive[ih])
+	{
+		if (fBuffered[ih]) fBuffers[ih].Fill(ekin, weight);
+		else fAnalysisManager->FillH1(ih, ekin, weight);
+	}
+	fEkin[ih] += ekin * weight;
+	fEventEkin[ih] += ekin * weight;
+}
+
+inline void RunAction::Record(const G4Track* track, const G4StepPoint* point)
+{
+	if (fRecordDetectorEntry) RecordAt(track, point, point->GetPosition());
+}
+
+inline void RunAction::RecordAt(const G4Track* track, const G4StepPoint* point,
+	const G4ThreeVector& position)
+{
+	if (!fPhaseSpace->IsOpen()) return;
+
+	fPhaseSpace->Fill(track->GetDefinition()->GetPDGEncoding(), point->GetKineticEnergy(),
+		position, point->GetMomentumDirection(), track->GetWeight(),
+		fEventID, point->GetGlobalTime());
+}
+
+inline void RunAction::RecordAt(const G4Track* track, const G4ThreeVector& position,
+	G4double time)
+{
+	if (!fPhaseSpace->IsOpen()) return;
+
+	fPhaseSpace->Fill(track->GetDefinition()->GetPDGEncoding(), track->GetKineticEnergy(),
+		position, track->GetMomentumDirection(), track->GetWeight(), fEventID, time);
+}
+
 #endif // !RunAction_h
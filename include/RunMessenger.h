@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/RunMessenger.h
+/// \brief Definition of the RunMessenger class
+
+#pragma once
+
+#ifndef RunMessenger_h
+#define RunMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+class RunAction;
+
+/// Messenger class that defines commands for RunAction.
+///
+/// It implements commands:
+/// - /stat/verbose level
+/// - /stat/targetRelError spectrum value
+/// - /stat/targetBinRelError spectrum value
+/// - /stat/targetEntries spectrum value
+/// - /stat/minEvents nb
+/// - /stat/checkInterval nb
+/// - /stat/clearTargets
+
+class RunMessenger : public G4UImessenger
+{
+public:
+	RunMessenger(RunAction* run);
+	~RunMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	RunAction* fRunAction{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcmdWithAnInteger* fVerboseCmd{ nullptr };
+	G4UIcommand* fTargetRelErrorCmd{ nullptr };
+	G4UIcommand* fTargetBinRelErrorCmd{ nullptr };
+	G4UIcommand* fTargetEntriesCmd{ nullptr };
+	G4UIcmdWithAnInteger* fMinEventsCmd{ nullptr };
+	G4UIcmdWithAnInteger* fCheckIntervalCmd{ nullptr };
+	G4UIcmdWithoutParameter* fClearTargetsCmd{ nullptr };
+};
+
+#endif // !RunMessenger_h
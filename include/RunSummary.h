@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/RunSummary.h
+/// \brief Definition of the RunSummary class
+
+#pragma once
+
+#ifndef RunSummary_h
+#define RunSummary_h
+
+#include "globals.hh"
+#include <array>
+#include <map>
+#include <vector>
+
+/// Content of a run summary (.summary), as written by RunAction.
+///
+/// The summary is a text file of records, one per line:
+/// - shard index count
+/// - shards index... : shards summed in a merged summary (absent for a
+///   single shard, whose index is then the only one)
+/// - seed baseSeed seed
+/// - events nb
+/// - ekin ih sum sum2 : kinetic energy total of a spectrum
+/// - sum ih sw sw2 : integral of a spectrum, with its error per history
+/// - h1 ih nbins edges... : binning of a spectrum, followed by its bins
+/// - bin ibin entries sw sw2 sxw sx2w : bin 0 and nbins + 1 being the
+///   underflow and overflow
+/// Lines of other records (e.g. # comments) are skipped.
+/// It only uses the Geant4 types, without its libraries, so that the
+/// tools (merge, benchmark) read the summaries as the application does.
+
+class RunSummary
+{
+public:
+	/// Sums of a bin: entries, sw, sw2, sxw, sx2w
+	using Bin = std::array<G4double, 5>;
+
+	struct Spectrum
+	{
+		G4int nbins{ 0 };
+		std::vector<G4double> edges;
+		std::vector<Bin> bins;
+	};
+
+	/// Reads a summary, false if it cannot be opened
+	G4bool Read(const G4String& fileName);
+
+	G4int shardIndex{ -1 };
+	G4int shardCount{ 0 };
+	std::vector<G4int> shardIndices;
+	G4long baseSeed{ 0 };
+	G4long seed{ 0 };
+	G4long nofEvents{ 0 };
+
+	// Per spectrum slot: sum and sum2 of the ekin and sum records
+	std::map<G4int, std::array<G4double, 2>> ekin;
+	std::map<G4int, std::array<G4double, 2>> sums;
+	std::map<G4int, Spectrum> spectra;
+};
+
+#endif // !RunSummary_h
@@ -0,0 +1,120 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/RunTelemetry.h
+/// \brief Definition of the RunTelemetry class
+
+#pragma once
+
+#ifndef RunTelemetry_h
+#define RunTelemetry_h
+
+#include "globals.hh"
+#include <array>
+#include <chrono>
+#include <cmath>
+
+/// Thread-local throughput counters of a run.
+///
+/// Each thread simulating events times its events (into a logarithmic
+/// histogram of the time per event), counts the steps of its tracks and
+/// measures its startup (from the start of the run by the master to its
+/// first event) and idle times. At end of run the counters are merged,
+/// and the master prints the throughput and load balance of the threads
+/// and writes them as JSON to <analysis file>_telemetry.json.
+
+class RunTelemetry
+{
+public:
+	// Time per event histogram: 20 bins per decade from 0.1 us
+	static constexpr G4int kNbOfBins = 200;
+	static constexpr G4double kMinTime = 1.0e-7;
+	static constexpr G4double kBinsPerDecade = 20.0;
+
+	struct Counters
+	{
+		G4int threadId{ 0 };
+		G4long events{ 0 };
+		G4long steps{ 0 };
+		G4double wallTime{ 0.0 };
+		G4double busyTime{ 0.0 };
+		G4double startupTime{ 0.0 };
+		G4double maxEventTime{ 0.0 };
+		std::array<G4long, kNbOfBins> eventTimes{};
+	};
+
+	/// Marks the start of the run, before the threads start (master)
+	static void StartRun();
+
+	void BeginOfRun();
+	inline void BeginOfEvent();
+	inline void EndOfEvent();
+	void AddSteps(G4int nb) { fCounters.steps += nb; }
+
+	/// Merges the counters of this thread
+	void EndOfRun();
+
+	/// Prints the merged counters and writes them as JSON (master)
+	static void Report(const G4String& fileName, G4int runID, G4double wallTime, G4bool print);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static G4double Seconds(Clock::duration duration)
+	{
+		return std::chrono::duration<G4double>(duration).count();
+	}
+
+	static Clock::time_point fRunStart;
+
+	Counters fCounters;
+	Clock::time_point fBeginOfRun;
+	Clock::time_point fBeginOfEvent;
+};
+
+inline void RunTelemetry::BeginOfEvent()
+{
+	fBeginOfEvent = Clock::now();
+	if (fCounters.events == 0) fCounters.startupTime = Seconds(fBeginOfEvent - fRunStart);
+}
+
+inline void RunTelemetry::EndOfEvent()
+{
+	auto time = Seconds(Clock::now() - fBeginOfEvent);
+	fCounters.events++;
+	fCounters.busyTime += time;
+	if (time > fCounters.maxEventTime) fCounters.maxEventTime = time;
+
+	G4int bin = 0;
+	if (time > kMinTime)
+	{
+		bin = static_cast<G4int>(kBinsPerDecade * std::log10(time / kMinTime));
+		if (bin >= kNbOfBins) bin = kNbOfBins - 1;
+	}
+	fCounters.eventTimes[bin]++;
+}
+
+#endif // !RunTelemetry_h
@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ScanManager.h
+/// \brief Definition of the ScanManager class
+
+#pragma once
+
+#ifndef ScanManager_h
+#define ScanManager_h
+
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+class ScanMessenger;
+
+/// Absorber parameter sweep.
+///
+/// Runs every combination of the registered materials, thicknesses and
+/// layer counts in the same process: only the geometry is rebuilt between
+/// the runs, the physics and the worker threads are kept alive.
+/// Each configuration is written to its own analysis file.
+/// The fast simulation of the absorbers can also be compared with the full
+/// simulation of the current configuration, in two runs of the same size.
+
+class ScanManager
+{
+public:
+	ScanManager(DetectorConstruction* det);
+	~ScanManager();
+
+	void AddMaterial(const G4String& mat) { fMaterials.push_back(mat); }
+	void AddThickness(G4double thick) { fThicknesses.push_back(thick); }
+	void AddLayerCount(G4int nb) { fLayerCounts.push_back(nb); }
+	void SetFileName(const G4String& name) { fFileName = name; }
+	void Clear();
+
+	void BeamOn(G4int nofEvents);
+	void CompareFastSimulation(G4int nofEvents);
+
+private:
+	G4String GetConfigName(const G4String& mat, G4double thick, G4int nb) const;
+
+	DetectorConstruction* fDetConstruction{ nullptr };
+	ScanMessenger* fMessenger{ nullptr };
+
+	std::vector<G4String> fMaterials;
+	std::vector<G4double> fThicknesses;
+	std::vector<G4int> fLayerCounts;
+	G4String fFileName{ "scan" };
+};
+
+#endif // !ScanManager_h
@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/ScanMessenger.h
+/// \brief Definition of the ScanMessenger class
+
+#pragma once
+
+#ifndef ScanMessenger_h
+#define ScanMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+class ScanManager;
+
+/// Messenger class that defines commands for ScanManager.
+///
+/// It implements commands:
+/// - /scan/addMaterial name
+/// - /scan/addThickness value unit
+/// - /scan/addLayerCount nb
+/// - /scan/setFileName name
+/// - /scan/clear
+/// - /scan/beamOn nofEvents
+/// - /scan/compareFastSim nofEvents
+
+class ScanMessenger : public G4UImessenger
+{
+public:
+	ScanMessenger(ScanManager* scan);
+	~ScanMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	ScanManager* fScanManager{ nullptr };
+
+	G4UIdirectory* fDirectory{ nullptr };
+	G4UIcmdWithAString* fAddMatCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fAddThickCmd{ nullptr };
+	G4UIcmdWithAnInteger* fAddLayerCountCmd{ nullptr };
+	G4UIcmdWithAString* fFileNameCmd{ nullptr };
+	G4UIcmdWithoutParameter* fClearCmd{ nullptr };
+	G4UIcmdWithAnInteger* fBeamOnCmd{ nullptr };
+	G4UIcmdWithAnInteger* fCompareFastSimCmd{ nullptr };
+};
+
+#endif // !ScanMessenger_h
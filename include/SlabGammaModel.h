@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/SlabGammaModel.h
+/// \brief Definition of the SlabGammaModel class
+
+#pragma once
+
+#ifndef SlabGammaModel_h
+#define SlabGammaModel_h
+
+#include "G4VFastSimulationModel.hh"
+#include <memory>
+
+class SlabTransmission;
+
+/// Fast simulation of the photons entering an absorber slab.
+///
+/// Triggered only on the front face of the region envelope, going in,
+/// within its energy range and the one of the transmission tables of the
+/// slab (see SlabTransmission), without which it is never triggered.
+/// The photon crosses the slab without interaction with the tabulated
+/// probability at normal incidence, raised to 1/cos of its incidence angle,
+/// and is then moved to its exit in one step. Otherwise the number of
+/// photons leaving the slab through its exit face is sampled from the
+/// tabulated mean yield, and each one its energy, angle to the normal and
+/// lateral offset, in a uniform azimuth, from the point where the entering
+/// photon would have left the slab: the first one is the primary moved to
+/// its exit point, the others are created there, and the remaining energy
+/// is deposited at once. The tables are taken at normal incidence and
+/// about the normal: the photons backscattered or leaving through the side
+/// of the slab, and the charged particles, are not emitted, nor the
+/// exits falling outside the slab.
+
+class SlabGammaModel : public G4VFastSimulationModel
+{
+public:
+	SlabGammaModel(const G4String& name, G4Region* envelope);
+	~SlabGammaModel() override = default;
+
+	G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+	G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+	void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+	/// Validity range of the model
+	void SetEnergyRange(G4double minEnergy, G4double maxEnergy);
+
+	/// Transmission tables of the slab (null: never triggered)
+	void SetTransmission(std::shared_ptr<const SlabTransmission> transmission)
+		{ fTransmission = std::move(transmission); }
+
+private:
+	G4double fMinEnergy{ 0.0 };
+	G4double fMaxEnergy{ 0.0 };
+	std::shared_ptr<const SlabTransmission> fTransmission;
+};
+
+#endif // !SlabGammaModel_h
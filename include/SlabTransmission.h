@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/SlabTransmission.h
+/// \brief Definition of the SlabTransmission class
+
+#pragma once
+
+#ifndef SlabTransmission_h
+#define SlabTransmission_h
+
+#include "AliasTable.h"
+#include "globals.hh"
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+/// Transmission of the photons through an absorber slab, for its fast
+/// simulation (see SlabGammaModel).
+///
+/// For a photon entering the slab at normal incidence with an energy in
+/// bin i (the bins of the responses, see ResponseMatrix): the probability
+/// to cross it without interaction, and for the photons which interact,
+/// the mean number of photons leaving the slab through its exit face with
+/// their joint distribution in energy bin and exit angle bin (the angle to
+/// the normal, in bins of equal width up to 90 degrees), and per angle bin
+/// the distribution of their lateral offset from the entry axis, in units
+/// of the thickness.
+/// The tables are filled by the response runs of the photons (see
+/// ResponseManager): the photons crossing the exit plane are scored in the
+/// Tally of each thread, merged at end of run, one run per energy bin.
+/// They are saved with the response matrix of the slab, and published for
+/// the fast simulation models of the worker threads.
+
+class SlabTransmission
+{
+public:
+	static constexpr G4int kNbOfAngles = 12;
+	static constexpr G4int kNbOfOffsets = 20;
+	static constexpr G4double kMaxOffset = 5.0;
+
+	/// Photons leaving the exit plane in one run, of a single energy bin
+	class Tally
+	{
+	public:
+		/// Binning of the energies, set by the master for the response runs
+		/// of the photons (0 bins: not scored)
+		static void SetBins(G4int nbOfBins, G4double maxEnergy);
+		static G4bool IsEnabled() { return fNbOfBins > 0; }
+
+		void BeginOfRun();
+		void Fill(G4bool direct, G4double energy, G4double cosTheta, G4double offset, G4double weight);
+
+		/// Adds the tally of this thread, of nofEvents events, to the merged one
+		void Merge(G4int nofEvents);
+
+		/// The merged tally, cleared
+		static Tally TakeMerged();
+
+	private:
+		friend class SlabTransmission;
+
+		static G4int fNbOfBins;
+		static G4double fMaxEnergy;
+
+		G4double fNbOfEvents{ 0.0 };
+		G4double fDirect{ 0.0 };
+		std::vector<G4double> fScattered;   // [energy bin][angle bin]
+		std::vector<G4double> fOffsets;     // [angle bin][offset bin]
+	};
+
+	/// Exit of a photon, in the frame of the slab
+	struct Exit
+	{
+		G4double energy{ 0.0 };
+		G4double cosTheta{ 1.0 };
+		G4double offset{ 0.0 };
+	};
+
+	SlabTransmission(G4int nbOfBins, G4double maxEnergy);
+
+	/// Table of the energy bin from the tally of its run
+	void SetBin(G4int inBin, const Tally& tally);
+
+	/// Tables following the response matrix in its cache file
+	G4bool Read(std::istream& input);
+	void Write(std::ostream& output) const;
+
+	/// Shared tables of a slab, published by the master before the runs
+	/// and found by the models of the worker threads (null if none)
+	static void Publish(const G4String& material, G4double thickness,
+		std::shared_ptr<const SlabTransmission> transmission);
+	static std::shared_ptr<const SlabTransmission> Find(const G4String& material, G4double thickness);
+
+	G4double GetMaxEnergy() const { return fMaxEnergy; }
+
+	/// Probability to cross the slab without interaction at normal
+	/// incidence, and mean number of photons leaving it per photon which
+	/// interacts
+	G4double GetDirectFraction(G4double energy) const { return fDirect[GetBin(energy)]; }
+	G4double GetExitYield(G4double energy) const { return fYield[GetBin(energy)]; }
+
+	/// One of the photons leaving the slab, after an interaction
+	Exit SampleExit(G4double energy) const;
+
+private:
+	G4int GetBin(G4double energy) const;
+	void Finalize(G4int inBin);
+
+	G4int fNbOfBins{ 0 };
+	G4double fMaxEnergy{ 0.0 };
+
+	// Per energy bin of the entering photon
+	std::vector<G4double> fDirect;
+	std::vector<G4double> fYield;
+	std::vector<std::vector<G4double>> fScattered;
+	std::vector<std::vector<G4double>> fOffsets;
+	std::vector<AliasTable> fExitTables;
+};
+
+#endif // !SlabTransmission_h
@@ -0,0 +1,127 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/StackingAction.h
+/// \brief Definition of the StackingAction class
+
+#pragma once
+
+#ifndef StackingAction_h
+#define StackingAction_h
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+#include <unordered_map>
+
+class DetectorConstruction;
+class G4Material;
+class PrimaryGeneratorAction;
+class RunAction;
+class StackingMessenger;
+
+/// Stacking action class.
+///
+/// It biases the emission direction of the source particles, i.e. the
+/// primaries which are not ions when the generator emits them isotropically
+/// and the non-ion products of radioactive decays, toward the cone
+/// subtended by the absorber/detector cylinder:
+/// - cone     : the direction is resampled inside the cone and the weight
+///              multiplied by the cone solid angle fraction (particles
+///              which would reach the detector only after scattering
+///              outside the cone are lost),
+/// - roulette : the direction is kept, particles outside the cone survive
+///              with a given probability and their weight is divided by it
+///              (unbiased).
+/// The cone encloses the front face of the stack (default) or of the
+/// detector. A source on the stack front face sees the stack as the whole
+/// forward hemisphere, so that only the detector target restricts its
+/// emission; the stack target suits a source standing off the stack.
+///
+/// With range rejection, electrons, protons and alphas born in an absorber
+/// layer are killed when their range in the layer material is shorter than
+/// the distance to the nearest surface of the layer volume (of the whole
+/// group for replicated layers): they cannot leave it, let alone reach the
+/// detector. Only particles below a maximum energy are rejected, and the
+/// electrons only while the fraction of their energy they would radiate
+/// (radiative yield of the layer material, from the stopping powers of
+/// G4EmCalculator) stays below a tolerance. The rejection is biased for
+/// photon scoring: the bremsstrahlung of the killed electrons is lost,
+/// the tolerance bounds this loss relative to their energy.
+/// With analytic neutrinos, electron neutrinos and antineutrinos are not
+/// transported: they are scored at creation if their straight path enters
+/// the detector, and killed.
+/// These options can be suspended in every thread at once, e.g. for the
+/// layer response runs, without changing them.
+
+class StackingAction : public G4UserStackingAction
+{
+public:
+	enum BiasingMode { kNoBiasing, kConeBiasing, kRouletteBiasing };
+	enum ConeTarget { kStackTarget, kDetectorTarget };
+
+	StackingAction(DetectorConstruction*, RunAction*, const PrimaryGeneratorAction*);
+	~StackingAction() override;
+
+	G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+
+	void SetBiasingMode(BiasingMode mode) { fBiasingMode = mode; }
+	void SetConeTarget(ConeTarget target) { fConeTarget = target; }
+	void SetSurvivalProbability(G4double prob) { fSurvivalProbability = prob; }
+	void SetRangeRejection(G4bool value) { fRangeRejection = value; }
+	void SetRangeRejectionMaxEnergy(G4double energy);
+	void SetRangeRejectionMaxYield(G4double yield);
+	void SetAnalyticNeutrinos(G4bool value) { fAnalyticNeutrinos = value; }
+
+	/// Suspend the options of every thread; set between runs
+	static void SetSuspended(G4bool value) { fSuspended = value; }
+
+private:
+	G4ClassificationOfNewTrack BiasEmission(const G4Track* track);
+	G4bool IsSourceParticle(const G4Track* track) const;
+	G4double GetConeCosTheta(const G4ThreeVector& position) const;
+	G4bool IsRangeRejected(const G4Track* track);
+	G4double GetElectronMaxEnergy(const G4Material* material);
+	void ScoreNeutrino(const G4Track* track);
+
+	DetectorConstruction* fDetConstruction{ nullptr };
+	RunAction* fRunAction{ nullptr };
+	const PrimaryGeneratorAction* fPrimaryGenerator{ nullptr };
+	StackingMessenger* fMessenger{ nullptr };
+
+	BiasingMode fBiasingMode{ kNoBiasing };
+	ConeTarget fConeTarget{ kStackTarget };
+	G4double fSurvivalProbability{ 0.1 };
+
+	G4bool fRangeRejection{ false };
+	G4double fRangeRejectionMaxEnergy{ 0.0 };
+	G4double fRangeRejectionMaxYield{ 1.e-3 };
+	std::unordered_map<const G4Material*, G4double> fElectronMaxEnergies;
+	G4bool fAnalyticNeutrinos{ false };
+
+	static G4bool fSuspended;
+};
+
+#endif // !StackingAction_h
@@ -0,0 +1,78 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/StackingMessenger.h
+/// \brief Definition of the StackingMessenger class
+
+#pragma once
+
+#ifndef StackingMessenger_h
+#define StackingMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+
+class StackingAction;
+
+/// Messenger class that defines commands for StackingAction.
+///
+/// It implements commands:
+/// - /bias/emission/mode none|cone|roulette
+/// - /bias/emission/target stack|detector
+/// - /bias/emission/survivalProbability value
+/// - /bias/rangeRejection bool
+/// - /bias/rangeRejectionMaxEnergy value unit
+/// - /bias/rangeRejectionMaxYield value
+/// - /bias/analyticNeutrinos bool
+
+class StackingMessenger : public G4UImessenger
+{
+public:
+	StackingMessenger(StackingAction* stacking);
+	~StackingMessenger() override;
+
+	void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+	StackingAction* fStackingAction{ nullptr };
+
+	G4UIdirectory* fBiasDirectory{ nullptr };
+	G4UIdirectory* fEmissionDirectory{ nullptr };
+	G4UIcmdWithAString* fEmissionModeCmd{ nullptr };
+	G4UIcmdWithAString* fConeTargetCmd{ nullptr };
+	G4UIcmdWithADouble* fSurvivalProbCmd{ nullptr };
+	G4UIcmdWithABool* fRangeRejectionCmd{ nullptr };
+	G4UIcmdWithADoubleAndUnit* fRangeRejectionMaxEnergyCmd{ nullptr };
+	G4UIcmdWithADouble* fRangeRejectionMaxYieldCmd{ nullptr };
+	G4UIcmdWithABool* fAnalyticNeutrinosCmd{ nullptr };
+};
+
+#endif // !StackingMessenger_h
@@ -32,26 +32,86 @@
 #ifndef SteppingAction_h
 #define SteppingAction_h
 
+#include "SlabTransmission.h"
 #include "G4UserSteppingAction.hh"
+#include "G4ThreeVector.hh"
+#include <vector>
 
+class G4StepPoint;
 class G4VPhysicalVolume;
 
+class DetectorConstruction;
+class Profiler;
 class RunAction;
 
 /// Stepping action class.
+///
+/// In the step scoring mode it scores the particles entering the detector.
+/// It also applies the importance biasing of the absorber layers: particles
+/// crossing into a more important layer are split, into a less important
+/// one they play Russian roulette. The world air is not part of the
+/// importance map: tracks leaving the stack into it, or coming back, keep
+/// their weight.
+/// When the phase space is recorded at a plane, the particles crossing it
+/// forward are recorded there and killed.
+/// For the layer responses, the particles leaving the stack through its
+/// exit face are scored there instead, and killed; in the photon runs, the
+/// photons also fill the transmission tally of the thread.
+/// When profiling, every step is first handed to the profiler.
+/// With acceptance culling, the tracks whose straight path misses the
+/// stack and detector cylinder are killed where they enter the world, or
+/// where they are born in it.
+/// When none of these is selected for the run, the run action unregisters
+/// it (see IsNeeded), so that the steps pay no user code.
 
 class SteppingAction : public G4UserSteppingAction
 {
 public:
-	SteppingAction(RunAction*);
+	SteppingAction(DetectorConstruction*, RunAction*);
 	~SteppingAction() override = default;
 
 	void UserSteppingAction(const G4Step* aStep) override;
 
+	/// Refresh the geometry dependent state, called at begin of run
+	void BeginOfRun();
+
+	/// Whether the run needs the action, once BeginOfRun is called
+	G4bool IsNeeded() const { return fNeeded; }
+
 private:
+	G4double GetImportance(const G4StepPoint* point) const;
+	void ApplyImportance(const G4Step* step, G4double ratio);
+	G4bool IsInWorld(const G4StepPoint* point) const;
+	G4bool IsCulled(const G4ThreeVector& position, const G4ThreeVector& direction) const;
+
+	DetectorConstruction* fDetConstruction{ nullptr };
 	RunAction* fRunAction{ nullptr };
 
+	G4bool fNeeded{ true };
+
 	G4VPhysicalVolume* fDetector{ nullptr };
+	G4bool fStepScoring{ true };
+
+	G4bool fExitPlaneScoring{ false };
+	G4double fExitZ{ 0.0 };
+	SlabTransmission::Tally* fTransmissionTally{ nullptr };
+	G4double fSlabThickness{ 0.0 };
+
+	G4bool fPlaneRecording{ false };
+	G4double fPlaneZ{ 0.0 };
+
+	G4bool fCulling{ false };
+	G4bool fKeepBackscatter{ false };
+	G4double fStackFrontZ{ 0.0 };
+	G4double fDetectorBackZ{ 0.0 };
+	G4double fRadius{ 0.0 };
+
+	Profiler* fProfiler{ nullptr };
+	G4bool fProfiling{ false };
+
+	G4bool fImportanceBiasing{ false };
+	std::vector<G4double> fImportances;
+	G4double fDetectorImportance{ 1.0 };
 };
 
 #endif // !SteppingAction_h
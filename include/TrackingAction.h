@@ -0,0 +1,56 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/include/TrackingAction.h
+/// \brief Definition of the TrackingAction class
+
+#pragma once
+
+#ifndef TrackingAction_h
+#define TrackingAction_h
+
+#include "G4UserTrackingAction.hh"
+
+class RunAction;
+
+/// Tracking action class.
+///
+/// It passes the number of steps of each finished track to the run
+/// action for the throughput telemetry.
+
+class TrackingAction : public G4UserTrackingAction
+{
+public:
+	TrackingAction(RunAction* runAction);
+	~TrackingAction() override = default;
+
+	void PostUserTrackingAction(const G4Track* track) override;
+
+private:
+	RunAction* fRunAction{ nullptr };
+};
+
+#endif // !TrackingAction_h
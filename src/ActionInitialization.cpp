@@ -30,17 +30,41 @@
 #include "ActionInitialization.h"
 #include "PrimaryGeneratorAction.h"
 #include "RunAction.h"
+#include "EventAction.h"
+#include "TrackingAction.h"
 #include "SteppingAction.h"
+#include "StackingAction.h"
+
+ActionInitialization::ActionInitialization(DetectorConstruction* det)
+    : fDetConstruction(det)
+{}
 
 void ActionInitialization::BuildForMaster() const
 {
-    SetUserAction(new RunAction);
+    // The master generates no event, its generator follows the source
+    // commands to prepare the tables of each run
+    auto runAction = new RunAction;
+    runAction->SetPrimaryGenerator(new PrimaryGeneratorAction, true);
+    SetUserAction(runAction);
 }
 
 void ActionInitialization::Build() const
 {
-    SetUserAction(new PrimaryGeneratorAction);
+    auto primaryGenerator = new PrimaryGeneratorAction;
+    SetUserAction(primaryGenerator);
     auto runAction = new RunAction;
     SetUserAction(runAction);
-    SetUserAction(new SteppingAction(runAction));
+    SetUserAction(new EventAction(runAction));
+    SetUserAction(new TrackingAction(runAction));
+
+    // The run action refreshes the stepping action at begin of run
+    auto steppingAction = new SteppingAction(fDetConstruction, runAction);
+    SetUserAction(steppingAction);
+    runAction->SetSteppingAction(steppingAction);
+    runAction->SetPrimaryGenerator(primaryGenerator);
+
+    SetUserAction(new StackingAction(fDetConstruction, runAction, primaryGenerator));
+
+    // The sensitive detector of this thread scores through its run action
+    fDetConstruction->SetRunAction(runAction);
 }
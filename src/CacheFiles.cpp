@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/CacheFiles.cpp
+/// \brief Implementation of the CacheFiles class
+
+#include "CacheFiles.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+G4String CacheFiles::GetDirectory(const G4String& defaultDirectory, const char* value)
+{
+    if (!value) value = std::getenv("ABSORBER_TABLE_CACHE");
+    if (!value) return defaultDirectory;
+
+    G4String directory = value;
+    if (directory == "off") directory.clear();
+    return directory;
+}
+
+G4String CacheFiles::GetTmpPath(const G4String& path)
+{
+    std::ostringstream tmpPath;
+    tmpPath << path << ".tmp" << std::hex << std::random_device()();
+    return tmpPath.str();
+}
+
+G4bool CacheFiles::Commit(const G4String& tmpPath, const G4String& path)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    fs::rename(tmpPath.c_str(), path.c_str(), error);
+    if (!error) return true;
+
+    fs::remove_all(tmpPath.c_str(), error);
+    return false;
+}
+
+G4bool CacheFiles::Write(const G4String& fileName, const std::function<G4bool(std::ostream&)>& write)
+{
+    namespace fs = std::filesystem;
+
+    fs::path path(fileName.c_str());
+    std::error_code error;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), error);
+
+    auto tmpPath = GetTmpPath(fileName);
+    G4bool written = false;
+    {
+        std::ofstream file(tmpPath);
+        written = file && write(file) && file.flush();
+    }
+
+    if (!written)
+    {
+        fs::remove(tmpPath.c_str(), error);
+        return false;
+    }
+    return Commit(tmpPath, fileName);
+}
@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ConvergenceMonitor.cpp
+/// \brief Implementation of the ConvergenceMonitor class
+
+#include "ConvergenceMonitor.h"
+
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <cmath>
+
+G4bool ConvergenceMonitor::Targets::IsActive() const
+{
+    auto isSet = [](G4double target) { return target >= 0.0; };
+    return std::any_of(relError.begin(), relError.end(), isSet)
+        || std::any_of(binRelError.begin(), binRelError.end(), isSet)
+        || std::any_of(entries.begin(), entries.end(), isSet);
+}
+
+ConvergenceMonitor* ConvergenceMonitor::Instance()
+{
+    static ConvergenceMonitor instance;
+    return &instance;
+}
+
+void ConvergenceMonitor::Configure(const Targets& targets)
+{
+    G4AutoLock lock(&fMutex);
+    fTargets = targets;
+    fContributions.clear();
+    fConverged = false;
+    fConvergedEvents = 0;
+}
+
+G4int ConvergenceMonitor::Register()
+{
+    G4AutoLock lock(&fMutex);
+    fContributions.emplace_back();
+    return static_cast<G4int>(fContributions.size()) - 1;
+}
+
+void ConvergenceMonitor::Publish(G4int slot, const Contribution& contribution)
+{
+    G4AutoLock lock(&fMutex);
+    if (fConverged || slot < 0 || slot >= static_cast<G4int>(fContributions.size())) return;
+
+    fContributions[slot] = contribution;
+    if (!CheckTargets()) return;
+
+    fConverged = true;
+    fConvergedEvents = 0;
+    for (const auto& c : fContributions) fConvergedEvents += c.nofEvents;
+
+    // In multi-threaded mode the master run manager stops handing out
+    // events and forwards the abort to all the workers
+    auto masterRunManager = G4MTRunManager::GetMasterRunManager();
+    if (masterRunManager) masterRunManager->AbortRun(true);
+    else G4RunManager::GetRunManager()->AbortRun(true);
+}
+
+G4bool ConvergenceMonitor::CheckTargets() const
+{
+    G4int nofEvents = 0;
+    for (const auto& c : fContributions) nofEvents += c.nofEvents;
+    if (nofEvents < fTargets.minEvents) return false;
+
+    G4bool anyTarget = false;
+    auto target = [](const std::vector<G4double>& targets, std::size_t ih)
+    {
+        return (ih < targets.size()) ? targets[ih] : -1.0;
+    };
+
+    std::size_t nofSpectra = std::max({ fTargets.relError.size(),
+        fTargets.binRelError.size(), fTargets.entries.size() });
+
+    for (std::size_t ih = 0; ih < nofSpectra; ih++)
+    {
+        auto relErrorTarget = target(fTargets.relError, ih);
+        auto binRelErrorTarget = target(fTargets.binRelError, ih);
+        auto entriesTarget = target(fTargets.entries, ih);
+        if (relErrorTarget < 0.0 && binRelErrorTarget < 0.0 && entriesTarget < 0.0) continue;
+        anyTarget = true;
+
+        // Sum the bins over the threads
+        std::vector<G4double> entries, sw, sw2;
+        G4double sum2 = 0.0;
+        for (const auto& c : fContributions)
+        {
+            if (ih >= c.spectra.size()) continue;
+            const auto& spectrum = c.spectra[ih];
+            sum2 += spectrum.sum2;
+            if (sw.size() < spectrum.sw.size())
+            {
+                entries.resize(spectrum.sw.size(), 0.0);
+                sw.resize(spectrum.sw.size(), 0.0);
+                sw2.resize(spectrum.sw.size(), 0.0);
+            }
+            for (std::size_t ibin = 0; ibin < spectrum.sw.size(); ibin++)
+            {
+                entries[ibin] += spectrum.entries[ibin];
+                sw[ibin] += spectrum.sw[ibin];
+                sw2[ibin] += spectrum.sw2[ibin];
+            }
+        }
+
+        G4double nofEntries = 0.0;
+        G4double sum = 0.0;
+        G4double maxRelErr = 0.0;
+        for (std::size_t ibin = 0; ibin < sw.size(); ibin++)
+        {
+            nofEntries += entries[ibin];
+            if (sw[ibin] <= 0.0) continue;
+            sum += sw[ibin];
+            maxRelErr = std::max(maxRelErr, std::sqrt(sw2[ibin]) / sw[ibin]);
+        }
+
+        if (sum <= 0.0) return false;
+        if (relErrorTarget >= 0.0 && std::sqrt(sum2) / sum > relErrorTarget) return false;
+        if (binRelErrorTarget >= 0.0 && maxRelErr > binRelErrorTarget) return false;
+        if (entriesTarget >= 0.0 && nofEntries < entriesTarget) return false;
+    }
+
+    return anyTarget;
+}
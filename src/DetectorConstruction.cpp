@@ -29,32 +29,72 @@
 
 #include "DetectorConstruction.h"
 #include "DetectorMessenger.h"
+#include "DetectorSD.h"
+#include "SlabGammaModel.h"
+#include "SlabTransmission.h"
 
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4Tubs.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4GeometryManager.hh"
+#include "G4GeometryTolerance.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4SDManager.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4UserLimits.hh"
+#include "G4GlobalFastSimulationManager.hh"
+#include "G4FastSimulationManager.hh"
+#include "G4EmCalculator.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
 #include "G4PhysicalConstants.hh"
+#include "G4UIcommand.hh"
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+G4ThreadLocal RunAction* DetectorConstruction::fRunAction = nullptr;
 
 DetectorConstruction::DetectorConstruction()
 {
+    fImportanceEnergy = 100 * keV;
+    fFastSimMinEnergy = 50 * keV;
+    fFastSimMaxEnergy = 3 * MeV;
     fMessenger = new DetectorMessenger(this);
 }
 
 DetectorConstruction::~DetectorConstruction()
 {
     delete fMessenger;
+    delete fUserLimits;
 }
 
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
-    // Get nist material manager
-    auto nist = G4NistManager::Instance();
+    // Cleanup old geometry, if any, so that the absorbers can be
+    // rebuilt between runs (see /run/reinitializeGeometry)
+    G4GeometryManager::GetInstance()->OpenGeometry();
+    G4PhysicalVolumeStore::GetInstance()->Clean();
+    G4LogicalVolumeStore::GetInstance()->Clean();
+    G4SolidStore::GetInstance()->Clean();
+
+    fLayerIndex.clear();
+    fLayerMat.clear();
+    fAbsorberRegions.clear();
 
     // Air defined using NIST Manager
-    auto air = nist->FindOrBuildMaterial("G4_AIR");
+    auto air = GetMaterial("G4_AIR");
 
     // Sizes of the principal geometrical components (solids)
 
@@ -68,11 +108,29 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     //
     G4bool checkOverlaps = true;
 
+    // Check the absorber stack
+    //
+    G4bool wantAbso = fIWantAbso && fNbOfAbso >= 1
+        && fAbsoThick.size() == fNbOfAbso
+        && fAbsoMat.size() == fNbOfAbso;
+
+    G4double stackThick = 0.0;
+    if (wantAbso)
+    {
+        for (auto thick : fAbsoThick) stackThick += thick;
+    }
+
+    // The world is extended along z only if the source, the stack and
+    // the detector do not fit, keeping the same margin around them
+    constexpr G4double worldMargin = 4 * mm;
+    G4double extentZ = std::max(std::abs(position), position + stackThick + detectorLength);
+    G4double worldSizeZ = std::max(worldSize, 2 * (extentZ + worldMargin));
+
     //
     // World
     //
     auto worldS = new G4Box("World",                  // its name
-        worldSize / 2, worldSize / 2, worldSize / 2); // its size
+        worldSize / 2, worldSize / 2, worldSizeZ / 2); // its size
 
     auto worldLV = new G4LogicalVolume(worldS,  // its solid
         air,                                    // its material
@@ -89,48 +147,82 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
         0,                                      // copy number
         checkOverlaps);                         // overlaps checking
 
+    fRadius = detectorRadius;
+    fStackFrontZ = position;
+
     //
     // Absorber(s)
     //
-    if (fIWantAbso && fNbOfAbso >= 1
-        && fAbsoThick.size() == fNbOfAbso
-        && fAbsoMat.size() == fNbOfAbso)
+    // Identical consecutive layers are grouped in a single volume,
+    // either as one slab (collapsed) or replicated along z
+    //
+    if (wantAbso)
     {
         G4cout << "Preparing to define " << fNbOfAbso << " absorber(s)."
             << G4endl;
-        for (G4int i = 1; i <= fNbOfAbso; i++)
+        for (G4int i = 0; i < fNbOfAbso; )
         {
-            auto absoMat = nist->FindOrBuildMaterial(fAbsoMat[i - 1]);
-
-            if (absoMat && fAbsoThick[i - 1] > 0.0)
-            {
-                G4ThreeVector absoPos(0, 0, position + fAbsoThick[i - 1] / 2);
-                position += fAbsoThick[i - 1];
-                G4String absoName = "Absorber" + std::to_string(i);
+            auto absoMat = GetMaterial(fAbsoMat[i]);
+            auto thick = fAbsoThick[i];
 
-                auto absoS = new G4Tubs(absoName,                           // its name
-                    0, detectorRadius, fAbsoThick[i - 1] / 2, 0, twopi);    // its size
-
-                auto absoLV = new G4LogicalVolume(absoS,    // its solid
-                    absoMat,                                // its material
-                    absoName);                              // its name
-
-                new G4PVPlacement(nullptr,  // no rotation
-                    absoPos,                // at position
-                    absoLV,                 // its logical volume
-                    absoName,               // its name
-                    worldLV,                // its mother  volume
-                    false,                  // no boolean operation
-                    0,                      // copy number
-                    checkOverlaps);         // overlaps checking
-            }
-            else
+            if (!absoMat || thick <= 0.0)
             {
-                G4cout << "Warning: Absorber " << i
+                G4cout << "Warning: Absorber " << i + 1
                     << " is not defined for wrong Material or Thickness!"
                     << G4endl;
                 break;
             }
+
+            G4int nbOfLayers = GetNbOfGroupedLayers(i);
+            G4double groupThick = nbOfLayers * thick;
+            G4ThreeVector absoPos(0, 0, position + groupThick / 2);
+            position += groupThick;
+            G4String absoName = "Absorber" + std::to_string(i + 1);
+
+            auto absoS = new G4Tubs(absoName,                       // its name
+                0, detectorRadius, groupThick / 2, 0, twopi);       // its size
+
+            auto absoLV = new G4LogicalVolume(absoS,    // its solid
+                absoMat,                                // its material
+                absoName);                              // its name
+            absoLV->SetUserLimits(GetUserLimits());
+            SetRegion(absoLV, GetLayerCut(i));
+            fAbsorberRegions.push_back({ absoName, fFastSimulation && GetLayerFastSimulation(i),
+                fAbsoMat[i], groupThick });
+
+            auto absoPV = new G4PVPlacement(nullptr,    // no rotation
+                absoPos,                                // at position
+                absoLV,                                 // its logical volume
+                absoName,                               // its name
+                worldLV,                                // its mother  volume
+                false,                                  // no boolean operation
+                0,                                      // copy number
+                checkOverlaps);                         // overlaps checking
+            fLayerIndex[absoPV] = i;
+
+            if (nbOfLayers > 1 && !fCollapseLayers)
+            {
+                G4String layerName = absoName + "Layer";
+
+                auto layerS = new G4Tubs(layerName,                 // its name
+                    0, detectorRadius, thick / 2, 0, twopi);        // its size
+
+                auto layerLV = new G4LogicalVolume(layerS,  // its solid
+                    absoMat,                                // its material
+                    layerName);                             // its name
+                layerLV->SetUserLimits(GetUserLimits());
+
+                auto layerPV = new G4PVReplica(layerName,   // its name
+                    layerLV,                                // its logical volume
+                    absoLV,                                 // its mother volume
+                    kZAxis,                                 // axis of replication
+                    nbOfLayers,                             // number of replica
+                    thick);                                 // width of replica
+                fLayerIndex[layerPV] = i;
+            }
+
+            fLayerMat.insert(fLayerMat.end(), nbOfLayers, absoMat);
+            i += nbOfLayers;
         }
     }
     else
@@ -141,6 +233,9 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     //
     // Detector
     //
+    fDetectorFrontZ = position;
+    fDetectorBackZ = position + detectorLength;
+
     G4ThreeVector detectorPos(0, 0, position + detectorLength / 2);
 
     auto detectorS = new G4Tubs("Detector",                 // its name
@@ -149,15 +244,16 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     auto detectorLV = new G4LogicalVolume(detectorS,    // its solid    
         air,                                            // its material
         "Detector");                                    // its name
+    SetRegion(detectorLV, fDetectorCut);
 
-    new G4PVPlacement(nullptr,  // no rotation
-        detectorPos,            // at position
-        detectorLV,             // its logical volume
-        "Detector",             // its name
-        worldLV,                // its mother  volume
-        false,                  // no boolean operation
-        0,                      // copy number
-        checkOverlaps);         // overlaps checking
+    fDetectorPV = new G4PVPlacement(nullptr,    // no rotation
+        detectorPos,                            // at position
+        detectorLV,                             // its logical volume
+        "Detector",                             // its name
+        worldLV,                                // its mother  volume
+        false,                                  // no boolean operation
+        0,                                      // copy number
+        checkOverlaps);                         // overlaps checking
 
     //
     // Always return the physical World
@@ -165,67 +261,172 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     return worldPV;
 }
 
-void DetectorConstruction::SetAbso1Thick(G4double thick)
+void DetectorConstruction::SetRegion(G4LogicalVolume* volume, G4double cut)
 {
-    G4int size = fAbsoThick.size();
-    if (size == 0)
-    {
-        fAbsoThick.push_back(thick);
-    }
-    else if (size == 1)
-    {
-        fAbsoThick[0] = thick;
-    }
-    else
+    // Regions are kept when the geometry is rebuilt, the deleted
+    // volumes remove themselves from their region
+    auto name = volume->GetName();
+    auto region = G4RegionStore::GetInstance()->FindOrCreateRegion(name);
+    region->AddRootLogicalVolume(volume);
+
+    // Without a cut of its own, the region follows the default cuts
+    if (cut <= 0.0)
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        region->SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts());
+        return;
     }
+
+    // The cut applies to the charged particles only: the photons keep
+    // the default cut, their range being no matter of the layer thickness
+    auto defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+    auto& cuts = fRegionCuts[name];
+    if (!cuts) cuts = new G4ProductionCuts;
+    cuts->SetProductionCut(defaultCuts->GetProductionCut("gamma"), "gamma");
+    cuts->SetProductionCut(cut, "e-");
+    cuts->SetProductionCut(cut, "e+");
+    cuts->SetProductionCut(cut, "proton");
+    region->SetProductionCuts(cuts);
+
+    G4cout << "Region " << name << ": production cut "
+        << G4BestUnit(cut, "Length") << " (e-, e+, proton)" << G4endl;
 }
 
-void DetectorConstruction::SetAbso2Thick(G4double thick)
+G4UserLimits* DetectorConstruction::GetUserLimits()
 {
-    G4int size = fAbsoThick.size();
-    if (size == 1)
+    if (fMaxStep <= 0.0 && fMinKinEnergy <= 0.0) return nullptr;
+
+    if (!fUserLimits) fUserLimits = new G4UserLimits;
+    fUserLimits->SetMaxAllowedStep(fMaxStep > 0.0 ? fMaxStep : DBL_MAX);
+    fUserLimits->SetUserMinEkine(fMinKinEnergy);
+    return fUserLimits;
+}
+
+G4double DetectorConstruction::GetDistanceToCylinder(const G4ThreeVector& position,
+    const G4ThreeVector& direction, G4double frontZ, G4double backZ) const
+{
+    auto radius2 = fRadius * fRadius;
+    auto inZ = [&](G4double z) { return z >= frontZ && z <= backZ; };
+
+    // Inside, or on the surface (within the tolerance) unless moving
+    // outward: the cylinder being convex, a path leaving it misses it
+    auto tolerance = 0.5 * G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+    auto rho = position.perp();
+    if (rho <= fRadius + tolerance && position.z() >= frontZ - tolerance
+        && position.z() <= backZ + tolerance)
     {
-        fAbsoThick.push_back(thick);
+        G4bool leaving = (rho >= fRadius - tolerance
+                && position.x() * direction.x() + position.y() * direction.y() > 0.0)
+            || (position.z() <= frontZ + tolerance && direction.z() < 0.0)
+            || (position.z() >= backZ - tolerance && direction.z() > 0.0);
+        return leaving ? -1.0 : 0.0;
     }
-    if (size == 2)
+
+    G4double distance = -1.0;
+    auto keep = [&distance](G4double t) { if (t >= 0.0 && (distance < 0.0 || t < distance)) distance = t; };
+
+    // End faces
+    if (direction.z() != 0.0)
     {
-        fAbsoThick[1] = thick;
+        for (auto z : { frontZ, backZ })
+        {
+            auto t = (z - position.z()) / direction.z();
+            if (t >= 0.0 && (position + t * direction).perp2() <= radius2) keep(t);
+        }
     }
-    else
+
+    // Side, entered at the first root of |p + t d|^2 = R^2 (in x, y)
+    auto a = direction.perp2();
+    auto c = position.perp2() - radius2;
+    if (a > 0.0 && c > 0.0)
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        auto b = position.x() * direction.x() + position.y() * direction.y();
+        auto discriminant = b * b - a * c;
+        if (discriminant >= 0.0)
+        {
+            auto t = (-b - std::sqrt(discriminant)) / a;
+            if (inZ(position.z() + t * direction.z())) keep(t);
+        }
     }
+
+    return distance;
 }
 
-void DetectorConstruction::SetAbso3Thick(G4double thick)
+void DetectorConstruction::ConstructSDandField()
 {
-    G4int size = fAbsoThick.size();
-    if (size == 2)
-    {
-        fAbsoThick.push_back(thick);
-    }
-    if (size == 3)
+    ConstructFastSimulation();
+
+    if (fScoringMode != kBoundaryScoring) return;
+
+    // The sensitive detector is kept when the geometry is rebuilt
+    auto sdManager = G4SDManager::GetSDMpointer();
+    auto detectorSD = sdManager->FindSensitiveDetector("Detector", false);
+    if (!detectorSD)
     {
-        fAbsoThick[2] = thick;
+        detectorSD = new DetectorSD("Detector", fRunAction);
+        sdManager->AddNewDetector(detectorSD);
     }
-    else
+    SetSensitiveDetector("Detector", detectorSD);
+}
+
+void DetectorConstruction::ConstructFastSimulation()
+{
+    // The models of each thread are kept when the geometry is rebuilt,
+    // as the regions, and only activated where the layers want them
+    auto globalManager = G4GlobalFastSimulationManager::GetGlobalFastSimulationManager();
+    for (const auto& absorberRegion : fAbsorberRegions)
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        // A slab without published transmission tables is fully simulated
+        auto fast = absorberRegion.fast;
+        std::shared_ptr<const SlabTransmission> transmission;
+        if (fast)
+        {
+            transmission = SlabTransmission::Find(absorberRegion.material, absorberRegion.thickness);
+            if (!transmission)
+            {
+                if (G4Threading::G4GetThreadId() <= 0)
+                {
+                    G4cout << "Warning: no transmission tables for " << absorberRegion.name
+                        << " (/resp/prepareFastSim), fast simulation not activated!" << G4endl;
+                }
+                fast = false;
+            }
+        }
+
+        auto modelName = absorberRegion.name + "Gamma";
+        auto model = static_cast<SlabGammaModel*>(globalManager->GetFastSimulationModel(modelName));
+        auto region = G4RegionStore::GetInstance()->GetRegion(absorberRegion.name, false);
+        if (!model && fast && region) model = new SlabGammaModel(modelName, region);
+        if (!model) continue;
+
+        model->SetEnergyRange(fFastSimMinEnergy, fFastSimMaxEnergy);
+        model->SetTransmission(transmission);
+        auto manager = region->GetFastSimulationManager();
+        if (fast) manager->ActivateFastSimulationModel(modelName);
+        else manager->InActivateFastSimulationModel(modelName);
     }
 }
 
-void DetectorConstruction::SetAbso4Thick(G4double thick)
+G4Material* DetectorConstruction::GetMaterial(const G4String& name)
+{
+    // Materials are resolved once and then taken from the cache
+    auto it = fMaterials.find(name);
+    if (it != fMaterials.end()) return it->second;
+
+    auto material = G4NistManager::Instance()->FindOrBuildMaterial(name);
+    fMaterials[name] = material;
+    return material;
+}
+
+void DetectorConstruction::SetAbsoThick(G4int i, G4double thick)
 {
     G4int size = fAbsoThick.size();
-    if (size == 3)
+    if (size == i)
     {
         fAbsoThick.push_back(thick);
     }
-    if (size == 4)
+    else if (size > i)
     {
-        fAbsoThick[3] = thick;
+        fAbsoThick[i] = thick;
     }
     else
     {
@@ -233,16 +434,16 @@ void DetectorConstruction::SetAbso4Thick(G4double thick)
     }
 }
 
-void DetectorConstruction::SetAbso1Mat(G4String mat)
+void DetectorConstruction::SetAbsoMat(G4int i, const G4String& mat)
 {
     G4int size = fAbsoMat.size();
-    if (size == 0)
+    if (size == i)
     {
         fAbsoMat.push_back(mat);
     }
-    else if (size == 1)
+    else if (size > i)
     {
-        fAbsoMat[0] = mat;
+        fAbsoMat[i] = mat;
     }
     else
     {
@@ -250,53 +451,218 @@ void DetectorConstruction::SetAbso1Mat(G4String mat)
     }
 }
 
-void DetectorConstruction::SetAbso2Mat(G4String mat)
+void DetectorConstruction::ClearAbsorbers()
 {
-    G4int size = fAbsoMat.size();
-    if (size == 1)
+    fAbsoThick.clear();
+    fAbsoMat.clear();
+    fNbOfAbso = 0;
+}
+
+void DetectorConstruction::AddAbsorber(const G4String& mat, G4double thick)
+{
+    fAbsoThick.push_back(thick);
+    fAbsoMat.push_back(mat);
+    fNbOfAbso = fAbsoThick.size();
+    fIWantAbso = true;
+}
+
+DetectorConstruction::Stack DetectorConstruction::GetStack() const
+{
+    return { fIWantAbso, fNbOfAbso, fAbsoThick, fAbsoMat,
+        fAbsoImportance, fAbsoCut, fAbsoFastSimulation };
+}
+
+void DetectorConstruction::SetStack(const Stack& stack)
+{
+    fIWantAbso = stack.wantAbso;
+    fNbOfAbso = stack.nbOfAbso;
+    fAbsoThick = stack.thick;
+    fAbsoMat = stack.mat;
+    fAbsoImportance = stack.importance;
+    fAbsoCut = stack.cut;
+    fAbsoFastSimulation = stack.fastSimulation;
+}
+
+void DetectorConstruction::ReadLayerTable(const G4String& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file)
     {
-        fAbsoMat.push_back(mat);
+        G4cout << "Warning: Layer table " << fileName
+            << " cannot be opened!" << G4endl;
+        return;
     }
-    else if (size == 2)
+
+    // One layer per line: material thickness unit
+    // Empty lines and lines starting with # are ignored
+    ClearAbsorbers();
+    G4String line;
+    G4int lineNb = 0;
+    while (std::getline(file, line))
     {
-        fAbsoMat[1] = mat;
+        lineNb++;
+        std::istringstream is(line);
+        G4String mat, unit;
+        G4double thick = 0.0;
+        if (!(is >> mat) || mat[0] == '#') continue;
+        if (!(is >> thick >> unit))
+        {
+            G4cout << "Warning: Wrong layer definition at line " << lineNb
+                << " of " << fileName << "!" << G4endl;
+            continue;
+        }
+        AddAbsorber(mat, thick * G4UIcommand::ValueOf(unit));
     }
-    else
+
+    G4cout << fNbOfAbso << " layer(s) read from " << fileName << "." << G4endl;
+}
+
+void DetectorConstruction::SetLayerImportance(G4int i, G4double importance)
+{
+    if (i < 0) return;
+    if (fAbsoImportance.size() <= static_cast<std::size_t>(i))
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        fAbsoImportance.resize(i + 1, 0.0);
     }
+    fAbsoImportance[i] = importance;
 }
 
-void DetectorConstruction::SetAbso3Mat(G4String mat)
+void DetectorConstruction::SetLayerCut(G4int i, G4double cut)
 {
-    G4int size = fAbsoMat.size();
-    if (size == 2)
+    if (i < 0) return;
+    if (fAbsoCut.size() <= static_cast<std::size_t>(i))
     {
-        fAbsoMat.push_back(mat);
+        fAbsoCut.resize(i + 1, 0.0);
+    }
+    fAbsoCut[i] = cut;
+}
+
+G4double DetectorConstruction::GetLayerCut(G4int i) const
+{
+    // 0 stands for the default cuts; in auto mode, explicit cuts
+    // take precedence over the fraction of the layer thickness
+    if (fCutMode == kDefaultCuts) return 0.0;
+    if (static_cast<std::size_t>(i) < fAbsoCut.size() && fAbsoCut[i] > 0.0) return fAbsoCut[i];
+    return GetAbsorberCut(fAbsoThick[i]);
+}
+
+G4double DetectorConstruction::GetAbsorberCut(G4double thick) const
+{
+    if (fCutMode != kAutoCuts) return 0.0;
+
+    // Auto cuts are not finer than the default electron cut (below the
+    // lower edge of the cuts table, the thresholds are clamped there anyway)
+    auto defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+    return std::max(fAutoCutFraction * thick, defaultCuts->GetProductionCut("e-"));
+}
+
+void DetectorConstruction::SetFastSimulation(G4bool value)
+{
+    if (value && !fFastSimulationPhysics)
+    {
+        G4cout << "Warning: no fast simulation physics (absorber -f 1),"
+            << " fast simulation ignored!" << G4endl;
+        value = false;
     }
-    else if (size == 3)
+    fFastSimulation = value;
+}
+
+void DetectorConstruction::SetLayerFastSimulation(G4int i, G4bool value)
+{
+    if (i < 0) return;
+    if (fAbsoFastSimulation.size() <= static_cast<std::size_t>(i))
     {
-        fAbsoMat[2] = mat;
+        fAbsoFastSimulation.resize(i + 1, true);
     }
-    else
+    fAbsoFastSimulation[i] = value;
+}
+
+G4bool DetectorConstruction::GetLayerFastSimulation(G4int i) const
+{
+    return (static_cast<std::size_t>(i) < fAbsoFastSimulation.size()) ? fAbsoFastSimulation[i] : true;
+}
+
+G4int DetectorConstruction::GetNbOfGroupedLayers(G4int i) const
+{
+    // A collapsed slab has a single importance, layers with
+    // different importances are not collapsed together
+    G4int nbOfLayers = 1;
+    while (i + nbOfLayers < fNbOfAbso
+        && fAbsoMat[i + nbOfLayers] == fAbsoMat[i]
+        && fAbsoThick[i + nbOfLayers] == fAbsoThick[i]
+        && GetLayerCut(i + nbOfLayers) == GetLayerCut(i)
+        && GetLayerFastSimulation(i + nbOfLayers) == GetLayerFastSimulation(i)
+        && (!fCollapseLayers || GetLayerImportance(i + nbOfLayers) == GetLayerImportance(i)))
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        nbOfLayers++;
     }
+    return nbOfLayers;
 }
 
-void DetectorConstruction::SetAbso4Mat(G4String mat)
+std::vector<std::pair<G4String, G4double>> DetectorConstruction::GetFastSimulationSlabs() const
 {
-    G4int size = fAbsoMat.size();
-    if (size == 3)
+    // The slabs as grouped by Construct, up to the first undefined layer
+    std::vector<std::pair<G4String, G4double>> slabs;
+    if (!fFastSimulation) return slabs;
+
+    for (G4int i = 0; i < fNbOfAbso; )
     {
-        fAbsoMat.push_back(mat);
+        if (fAbsoThick[i] <= 0.0
+            || !G4NistManager::Instance()->FindOrBuildMaterial(fAbsoMat[i]))
+        {
+            break;
+        }
+
+        G4int nbOfLayers = GetNbOfGroupedLayers(i);
+        if (GetLayerFastSimulation(i)) slabs.emplace_back(fAbsoMat[i], nbOfLayers * fAbsoThick[i]);
+        i += nbOfLayers;
     }
-    else if (size == 4)
+    return slabs;
+}
+
+void DetectorConstruction::SetFastSimulationEnergyRange(G4double minEnergy, G4double maxEnergy)
+{
+    if (minEnergy >= maxEnergy)
     {
-        fAbsoMat[3] = mat;
+        G4cout << "Warning: Wrong fast simulation energy range!" << G4endl;
+        return;
     }
-    else
+    fFastSimMinEnergy = minEnergy;
+    fFastSimMaxEnergy = maxEnergy;
+}
+
+G4double DetectorConstruction::GetLayerImportance(G4int i) const
+{
+    return (static_cast<std::size_t>(i) < fAbsoImportance.size()) ? fAbsoImportance[i] : 0.0;
+}
+
+std::vector<G4double> DetectorConstruction::ComputeImportances() const
+{
+    // A layer without an explicit importance takes the one of the previous
+    // layer, multiplied in auto mode by the gamma attenuation of that layer
+    // at the reference energy (limited to the maximum ratio)
+    std::vector<G4double> importances(fLayerMat.size(), 1.0);
+
+    G4EmCalculator emCalculator;
+    G4double importance = 1.0;
+    G4double ratio = 1.0;
+
+    for (std::size_t i = 0; i < fLayerMat.size(); i++)
     {
-        G4cout << "Warning: Wrong order!" << G4endl;
+        auto explicitImportance = GetLayerImportance(i);
+        importance = (explicitImportance > 0.0) ? explicitImportance : importance * ratio;
+        importances[i] = importance;
+
+        ratio = 1.0;
+        if (fImportanceMode == kAutoImportance)
+        {
+            auto length = emCalculator.ComputeGammaAttenuationLength(fImportanceEnergy, fLayerMat[i]);
+            if (length > 0.0)
+            {
+                ratio = std::min(std::exp(fAbsoThick[i] / length), fMaxImportanceRatio);
+            }
+        }
     }
+
+    return importances;
 }
@@ -33,8 +33,13 @@
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
 
 DetectorMessenger::DetectorMessenger(DetectorConstruction* det)
     : fDetConstruction(det)
@@ -91,6 +96,180 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* det)
     fAbso4MatCmd->SetGuidance("Set Material of the Absorber4.");
     fAbso4MatCmd->SetParameterName("choice", false);
     fAbso4MatCmd->AvailableForStates(G4State_PreInit);
+
+    fAddLayerCmd = new G4UIcommand("/det/addLayer", this);
+    fAddLayerCmd->SetGuidance("Append a layer to the absorber stack.");
+    fAddLayerCmd->SetGuidance("Identical consecutive layers share one volume.");
+    auto matPrm = new G4UIparameter("material", 's', false);
+    fAddLayerCmd->SetParameter(matPrm);
+    auto thickPrm = new G4UIparameter("thickness", 'd', false);
+    thickPrm->SetParameterRange("thickness>0.");
+    fAddLayerCmd->SetParameter(thickPrm);
+    auto unitPrm = new G4UIparameter("unit", 's', true);
+    unitPrm->SetDefaultUnit("mm");
+    fAddLayerCmd->SetParameter(unitPrm);
+    fAddLayerCmd->AvailableForStates(G4State_PreInit);
+
+    fClearLayersCmd = new G4UIcmdWithoutParameter("/det/clearLayers", this);
+    fClearLayersCmd->SetGuidance("Remove all layers of the absorber stack.");
+    fClearLayersCmd->AvailableForStates(G4State_PreInit);
+
+    fLayerTableCmd = new G4UIcmdWithAString("/det/readLayerTable", this);
+    fLayerTableCmd->SetGuidance("Read the absorber stack from a layer table file.");
+    fLayerTableCmd->SetGuidance("One layer per line: material thickness unit.");
+    fLayerTableCmd->SetParameterName("fileName", false);
+    fLayerTableCmd->AvailableForStates(G4State_PreInit);
+
+    fCollapseLayersCmd = new G4UIcmdWithABool("/det/collapseLayers", this);
+    fCollapseLayersCmd->SetGuidance("Build identical consecutive layers as one slab");
+    fCollapseLayersCmd->SetGuidance("instead of replicas along z.");
+    fCollapseLayersCmd->SetParameterName("collapse", false);
+    fCollapseLayersCmd->AvailableForStates(G4State_PreInit);
+
+    fScoringModeCmd = new G4UIcmdWithAString("/det/setScoringMode", this);
+    fScoringModeCmd->SetGuidance("Select how the detected particles are scored:");
+    fScoringModeCmd->SetGuidance("  step     : stepping action checking every step,");
+    fScoringModeCmd->SetGuidance("  boundary : sensitive detector, steps outside the");
+    fScoringModeCmd->SetGuidance("             detector do not reach user code.");
+    fScoringModeCmd->SetParameterName("mode", false);
+    fScoringModeCmd->SetCandidates("step boundary");
+    fScoringModeCmd->AvailableForStates(G4State_PreInit);
+
+    fImportanceModeCmd = new G4UIcmdWithAString("/det/setImportanceMode", this);
+    fImportanceModeCmd->SetGuidance("Split and roulette particles crossing the absorber layers:");
+    fImportanceModeCmd->SetGuidance("  off    : no importance biasing,");
+    fImportanceModeCmd->SetGuidance("  manual : importances set with /det/setLayerImportance,");
+    fImportanceModeCmd->SetGuidance("  auto   : importances from the gamma attenuation of the");
+    fImportanceModeCmd->SetGuidance("           layers, explicit importances take precedence.");
+    fImportanceModeCmd->SetParameterName("mode", false);
+    fImportanceModeCmd->SetCandidates("off manual auto");
+    fImportanceModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fLayerImportanceCmd = new G4UIcommand("/det/setLayerImportance", this);
+    fLayerImportanceCmd->SetGuidance("Set the importance of an absorber layer (1 = first).");
+    fLayerImportanceCmd->SetGuidance("Layers without importance keep the one of the previous layer.");
+    auto indexPrm = new G4UIparameter("index", 'i', false);
+    indexPrm->SetParameterRange("index>0");
+    fLayerImportanceCmd->SetParameter(indexPrm);
+    auto importancePrm = new G4UIparameter("importance", 'd', false);
+    importancePrm->SetParameterRange("importance>0.");
+    fLayerImportanceCmd->SetParameter(importancePrm);
+    fLayerImportanceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fImportanceEnergyCmd = new G4UIcmdWithADoubleAndUnit("/det/setImportanceEnergy", this);
+    fImportanceEnergyCmd->SetGuidance("Set the gamma energy used for the automatic importances.");
+    fImportanceEnergyCmd->SetParameterName("energy", false);
+    fImportanceEnergyCmd->SetRange("energy>0.");
+    fImportanceEnergyCmd->SetUnitCategory("Energy");
+    fImportanceEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fMaxImportanceRatioCmd = new G4UIcmdWithADouble("/det/setMaxImportanceRatio", this);
+    fMaxImportanceRatioCmd->SetGuidance("Limit the importance ratio between automatic layers.");
+    fMaxImportanceRatioCmd->SetParameterName("ratio", false);
+    fMaxImportanceRatioCmd->SetRange("ratio>=1.");
+    fMaxImportanceRatioCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCutModeCmd = new G4UIcmdWithAString("/det/setCutMode", this);
+    fCutModeCmd->SetGuidance("Select the production cuts of the absorber regions:");
+    fCutModeCmd->SetGuidance("  default : the default cuts of the physics list,");
+    fCutModeCmd->SetGuidance("  manual  : cuts set with /det/setLayerCut,");
+    fCutModeCmd->SetGuidance("  auto    : a fraction of the layer thickness,");
+    fCutModeCmd->SetGuidance("            explicit cuts take precedence.");
+    fCutModeCmd->SetGuidance("The cuts apply to e-, e+ and protons, gammas keep the default cut.");
+    fCutModeCmd->SetGuidance("Takes effect when the geometry is built.");
+    fCutModeCmd->SetParameterName("mode", false);
+    fCutModeCmd->SetCandidates("default manual auto");
+    fCutModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fLayerCutCmd = new G4UIcommand("/det/setLayerCut", this);
+    fLayerCutCmd->SetGuidance("Set the production cut of an absorber layer (1 = first).");
+    fLayerCutCmd->SetGuidance("Layers without cut use the default cuts in manual mode.");
+    auto cutIndexPrm = new G4UIparameter("index", 'i', false);
+    cutIndexPrm->SetParameterRange("index>0");
+    fLayerCutCmd->SetParameter(cutIndexPrm);
+    auto cutPrm = new G4UIparameter("cut", 'd', false);
+    cutPrm->SetParameterRange("cut>0.");
+    fLayerCutCmd->SetParameter(cutPrm);
+    auto cutUnitPrm = new G4UIparameter("unit", 's', true);
+    cutUnitPrm->SetDefaultUnit("mm");
+    fLayerCutCmd->SetParameter(cutUnitPrm);
+    fLayerCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fDetectorCutCmd = new G4UIcmdWithADoubleAndUnit("/det/setDetectorCut", this);
+    fDetectorCutCmd->SetGuidance("Set the production cut of the detector region,");
+    fDetectorCutCmd->SetGuidance("0 for the default cuts.");
+    fDetectorCutCmd->SetParameterName("cut", false);
+    fDetectorCutCmd->SetRange("cut>=0.");
+    fDetectorCutCmd->SetUnitCategory("Length");
+    fDetectorCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAutoCutFractionCmd = new G4UIcmdWithADouble("/det/setAutoCutFraction", this);
+    fAutoCutFractionCmd->SetGuidance("Set the fraction of the layer thickness used as");
+    fAutoCutFractionCmd->SetGuidance("production cut in auto mode (not below the default cut).");
+    fAutoCutFractionCmd->SetParameterName("fraction", false);
+    fAutoCutFractionCmd->SetRange("fraction>0.");
+    fAutoCutFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fMaxStepCmd = new G4UIcmdWithADoubleAndUnit("/det/setMaxStep", this);
+    fMaxStepCmd->SetGuidance("Limit the step of the charged particles in the absorbers,");
+    fMaxStepCmd->SetGuidance("0 for no limit.");
+    fMaxStepCmd->SetParameterName("step", false);
+    fMaxStepCmd->SetRange("step>=0.");
+    fMaxStepCmd->SetUnitCategory("Length");
+    fMaxStepCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fMinKinEnergyCmd = new G4UIcmdWithADoubleAndUnit("/det/setMinKinEnergy", this);
+    fMinKinEnergyCmd->SetGuidance("Kill the particles below this kinetic energy in the absorbers,");
+    fMinKinEnergyCmd->SetGuidance("0 for no limit.");
+    fMinKinEnergyCmd->SetParameterName("energy", false);
+    fMinKinEnergyCmd->SetRange("energy>=0.");
+    fMinKinEnergyCmd->SetUnitCategory("Energy");
+    fMinKinEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFastSimCmd = new G4UIcmdWithABool("/det/setFastSim", this);
+    fFastSimCmd->SetGuidance("Fast simulation of the photons entering the absorber layers,");
+    fFastSimCmd->SetGuidance("except those excluded with /det/setLayerFastSim.");
+    fFastSimCmd->SetGuidance("Takes effect when the geometry is built.");
+    fFastSimCmd->SetGuidance("Needs the fast simulation physics (absorber -f 1).");
+    fFastSimCmd->SetGuidance("Needs the transmission tables of the absorbers (/resp/prepareFastSim).");
+    fFastSimCmd->SetParameterName("value", false);
+    fFastSimCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fLayerFastSimCmd = new G4UIcommand("/det/setLayerFastSim", this);
+    fLayerFastSimCmd->SetGuidance("Include or exclude an absorber layer (1 = first)");
+    fLayerFastSimCmd->SetGuidance("from the fast simulation.");
+    auto fastIndexPrm = new G4UIparameter("index", 'i', false);
+    fastIndexPrm->SetParameterRange("index>0");
+    fLayerFastSimCmd->SetParameter(fastIndexPrm);
+    fLayerFastSimCmd->SetParameter(new G4UIparameter("value", 'b', false));
+    fLayerFastSimCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFastSimEnergyRangeCmd = new G4UIcommand("/det/setFastSimEnergyRange", this);
+    fFastSimEnergyRangeCmd->SetGuidance("Set the photon energy range of the fast simulation,");
+    fFastSimEnergyRangeCmd->SetGuidance("the other photons are fully simulated.");
+    auto minPrm = new G4UIparameter("min", 'd', false);
+    minPrm->SetParameterRange("min>0.");
+    fFastSimEnergyRangeCmd->SetParameter(minPrm);
+    auto maxPrm = new G4UIparameter("max", 'd', false);
+    maxPrm->SetParameterRange("max>0.");
+    fFastSimEnergyRangeCmd->SetParameter(maxPrm);
+    auto rangeUnitPrm = new G4UIparameter("unit", 's', true);
+    rangeUnitPrm->SetDefaultUnit("keV");
+    fFastSimEnergyRangeCmd->SetParameter(rangeUnitPrm);
+    fFastSimEnergyRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAcceptanceCullingCmd = new G4UIcmdWithABool("/det/setAcceptanceCulling", this);
+    fAcceptanceCullingCmd->SetGuidance("Kill the tracks in the world whose straight path");
+    fAcceptanceCullingCmd->SetGuidance("cannot reach the absorber stack or the detector.");
+    fAcceptanceCullingCmd->SetParameterName("value", false);
+    fAcceptanceCullingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fKeepBackscatterCmd = new G4UIcmdWithABool("/det/setKeepBackscatter", this);
+    fKeepBackscatterCmd->SetGuidance("With acceptance culling, keep the tracks which may still");
+    fKeepBackscatterCmd->SetGuidance("scatter back in the air: only those leaving the stack radius");
+    fKeepBackscatterCmd->SetGuidance("outward or the detector downstream are killed.");
+    fKeepBackscatterCmd->SetParameterName("value", false);
+    fKeepBackscatterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 DetectorMessenger::~DetectorMessenger()
@@ -105,6 +284,26 @@ DetectorMessenger::~DetectorMessenger()
     delete fAbso3MatCmd;
     delete fAbso4ThickCmd;
     delete fAbso4MatCmd;
+    delete fAddLayerCmd;
+    delete fClearLayersCmd;
+    delete fLayerTableCmd;
+    delete fCollapseLayersCmd;
+    delete fScoringModeCmd;
+    delete fImportanceModeCmd;
+    delete fLayerImportanceCmd;
+    delete fImportanceEnergyCmd;
+    delete fMaxImportanceRatioCmd;
+    delete fCutModeCmd;
+    delete fLayerCutCmd;
+    delete fDetectorCutCmd;
+    delete fAutoCutFractionCmd;
+    delete fMaxStepCmd;
+    delete fMinKinEnergyCmd;
+    delete fFastSimCmd;
+    delete fLayerFastSimCmd;
+    delete fFastSimEnergyRangeCmd;
+    delete fAcceptanceCullingCmd;
+    delete fKeepBackscatterCmd;
     delete fDirectory;
 }
 
@@ -122,41 +321,171 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
 
     if (command == fAbso1ThickCmd)
     {
-        fDetConstruction->SetAbso1Thick(fAbso1ThickCmd->GetNewDoubleValue(newValue));
+        fDetConstruction->SetAbsoThick(0, fAbso1ThickCmd->GetNewDoubleValue(newValue));
     }
 
     if (command == fAbso1MatCmd)
     {
-        fDetConstruction->SetAbso1Mat(newValue);
+        fDetConstruction->SetAbsoMat(0, newValue);
     }
 
     if (command == fAbso2ThickCmd)
     {
-        fDetConstruction->SetAbso2Thick(fAbso2ThickCmd->GetNewDoubleValue(newValue));
+        fDetConstruction->SetAbsoThick(1, fAbso2ThickCmd->GetNewDoubleValue(newValue));
     }
 
     if (command == fAbso2MatCmd)
     {
-        fDetConstruction->SetAbso2Mat(newValue);
+        fDetConstruction->SetAbsoMat(1, newValue);
     }
 
     if (command == fAbso3ThickCmd)
     {
-        fDetConstruction->SetAbso3Thick(fAbso3ThickCmd->GetNewDoubleValue(newValue));
+        fDetConstruction->SetAbsoThick(2, fAbso3ThickCmd->GetNewDoubleValue(newValue));
     }
 
     if (command == fAbso3MatCmd)
     {
-        fDetConstruction->SetAbso3Mat(newValue);
+        fDetConstruction->SetAbsoMat(2, newValue);
     }
 
     if (command == fAbso4ThickCmd)
     {
-        fDetConstruction->SetAbso4Thick(fAbso4ThickCmd->GetNewDoubleValue(newValue));
+        fDetConstruction->SetAbsoThick(3, fAbso4ThickCmd->GetNewDoubleValue(newValue));
     }
 
     if (command == fAbso4MatCmd)
     {
-        fDetConstruction->SetAbso4Mat(newValue);
+        fDetConstruction->SetAbsoMat(3, newValue);
+    }
+
+    if (command == fAddLayerCmd)
+    {
+        G4String mat, unit;
+        G4double thick = 0.0;
+        std::istringstream is(newValue);
+        is >> mat >> thick >> unit;
+        fDetConstruction->AddAbsorber(mat, thick * G4UIcommand::ValueOf(unit));
+    }
+
+    if (command == fClearLayersCmd)
+    {
+        fDetConstruction->ClearAbsorbers();
+    }
+
+    if (command == fLayerTableCmd)
+    {
+        fDetConstruction->ReadLayerTable(newValue);
+    }
+
+    if (command == fCollapseLayersCmd)
+    {
+        fDetConstruction->SetCollapseLayers(fCollapseLayersCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fScoringModeCmd)
+    {
+        fDetConstruction->SetScoringMode(newValue == "boundary"
+            ? DetectorConstruction::kBoundaryScoring
+            : DetectorConstruction::kStepScoring);
+    }
+
+    if (command == fImportanceModeCmd)
+    {
+        auto mode = DetectorConstruction::kNoImportance;
+        if (newValue == "manual") mode = DetectorConstruction::kManualImportance;
+        if (newValue == "auto") mode = DetectorConstruction::kAutoImportance;
+        fDetConstruction->SetImportanceMode(mode);
+    }
+
+    if (command == fLayerImportanceCmd)
+    {
+        G4int index = 0;
+        G4double importance = 0.0;
+        std::istringstream is(newValue);
+        is >> index >> importance;
+        fDetConstruction->SetLayerImportance(index - 1, importance);
+    }
+
+    if (command == fImportanceEnergyCmd)
+    {
+        fDetConstruction->SetImportanceEnergy(fImportanceEnergyCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fMaxImportanceRatioCmd)
+    {
+        fDetConstruction->SetMaxImportanceRatio(fMaxImportanceRatioCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fCutModeCmd)
+    {
+        auto mode = DetectorConstruction::kDefaultCuts;
+        if (newValue == "manual") mode = DetectorConstruction::kManualCuts;
+        if (newValue == "auto") mode = DetectorConstruction::kAutoCuts;
+        fDetConstruction->SetCutMode(mode);
+    }
+
+    if (command == fLayerCutCmd)
+    {
+        G4int index = 0;
+        G4double cut = 0.0;
+        G4String unit;
+        std::istringstream is(newValue);
+        is >> index >> cut >> unit;
+        fDetConstruction->SetLayerCut(index - 1, cut * G4UIcommand::ValueOf(unit));
+    }
+
+    if (command == fDetectorCutCmd)
+    {
+        fDetConstruction->SetDetectorCut(fDetectorCutCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fAutoCutFractionCmd)
+    {
+        fDetConstruction->SetAutoCutFraction(fAutoCutFractionCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fMaxStepCmd)
+    {
+        fDetConstruction->SetMaxStep(fMaxStepCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fMinKinEnergyCmd)
+    {
+        fDetConstruction->SetMinKinEnergy(fMinKinEnergyCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fFastSimCmd)
+    {
+        fDetConstruction->SetFastSimulation(fFastSimCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fLayerFastSimCmd)
+    {
+        G4int index = 0;
+        G4String value;
+        std::istringstream is(newValue);
+        is >> index >> value;
+        fDetConstruction->SetLayerFastSimulation(index - 1, G4UIcommand::ConvertToBool(value));
+    }
+
+    if (command == fFastSimEnergyRangeCmd)
+    {
+        G4double minEnergy = 0.0, maxEnergy = 0.0;
+        G4String unit;
+        std::istringstream is(newValue);
+        is >> minEnergy >> maxEnergy >> unit;
+        auto value = G4UIcommand::ValueOf(unit);
+        fDetConstruction->SetFastSimulationEnergyRange(minEnergy * value, maxEnergy * value);
+    }
+
+    if (command == fAcceptanceCullingCmd)
+    {
+        fDetConstruction->SetAcceptanceCulling(fAcceptanceCullingCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fKeepBackscatterCmd)
+    {
+        fDetConstruction->SetKeepBackscatter(fKeepBackscatterCmd->GetNewBoolValue(newValue));
     }
 }
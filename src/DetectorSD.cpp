@@ -0,0 +1,56 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/DetectorSD.cpp
+/// \brief Implementation of the DetectorSD class
+
+#include "DetectorSD.h"
+#include "RunAction.h"
+
+#include "G4Step.hh"
+
+DetectorSD::DetectorSD(const G4String& name, RunAction* runAction)
+    : G4VSensitiveDetector(name), fRunAction(runAction)
+{}
+
+G4bool DetectorSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+    auto stepPoint = step->GetPreStepPoint();
+    auto track = step->GetTrack();
+    auto ekin = stepPoint->GetKineticEnergy();
+
+    // Energy spectrum
+    //
+    if (ekin > 0.0)
+    {
+        auto ih = fRunAction->GetSlot(track->GetDefinition());
+        if (ih) fRunAction->Score(ih, ekin, track->GetWeight());
+    }
+    fRunAction->Record(track, stepPoint);
+    track->SetTrackStatus(fStopAndKill);
+
+    return true;
+}
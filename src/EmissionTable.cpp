@@ -0,0 +1,506 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/EmissionTable.cpp
+/// \brief Implementation of the EmissionTable class
+
+#include "EmissionTable.h"
+#include "CacheFiles.h"
+
+#include "G4AutoLock.hh"
+#include "G4GenericIon.hh"
+#include "G4IonTable.hh"
+#include "G4ParticleTable.hh"
+#include "G4ProcessManager.hh"
+#include "G4RadioactiveDecay.hh"
+#include "G4HadronicParameters.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4VParticleChange.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+namespace
+{
+G4Mutex tablesMutex = G4MUTEX_INITIALIZER;
+G4String cacheDirectory;
+
+// Decays of the daughters of one decay, at most
+const G4int maxNbOfSteps = 1000;
+
+G4RadioactiveDecay* FindRadioactiveDecay()
+{
+    auto processManager = G4GenericIon::GenericIon()->GetProcessManager();
+    if (!processManager) return nullptr;
+
+    auto processes = processManager->GetProcessList();
+    for (std::size_t i = 0; i < processes->size(); i++)
+    {
+        if (auto process = dynamic_cast<G4RadioactiveDecay*>((*processes)[i])) return process;
+    }
+    return nullptr;
+}
+
+// Volumes of the radioactive decay, which has no getter for them
+struct RadioactiveDecayVolumes : public G4RadioactiveDecay
+{
+    static constexpr auto allVolumes = &RadioactiveDecayVolumes::isAllVolumesMode;
+    static constexpr auto volumes = &RadioactiveDecayVolumes::ValidVolumes;
+};
+}
+
+void EmissionTable::SetCacheDirectory(const G4String& directory)
+{
+    cacheDirectory = directory;
+}
+
+std::shared_ptr<const EmissionTable> EmissionTable::Get(G4int Z, G4int A, G4double excitation,
+    G4int nbOfDecays)
+{
+    using Key = std::tuple<G4int, G4int, G4long, G4int>;
+    static std::map<Key, std::shared_ptr<const EmissionTable>> tables;
+
+    G4AutoLock lock(&tablesMutex);
+
+    Key key{ Z, A, std::lround(excitation / eV), nbOfDecays };
+    auto it = tables.find(key);
+    if (it != tables.end()) return it->second;
+
+    const auto& directory = cacheDirectory;
+
+    std::ostringstream fileName;
+    if (!directory.empty()) fileName << directory << '/';
+    fileName << "emission_Z" << Z << "_A" << A;
+    if (std::get<2>(key) != 0)
+    {
+        fileName << "_E" << std::get<2>(key) << "eV";
+    }
+    fileName << "_N" << nbOfDecays << ".txt";
+
+    std::shared_ptr<EmissionTable> table(new EmissionTable(Z, A, excitation, nbOfDecays));
+    if (directory.empty() || !table->Load(fileName.str()))
+    {
+        if (table->Tabulate())
+        {
+            if (!directory.empty()) table->Save(fileName.str());
+        }
+        else
+        {
+            table.reset();
+        }
+    }
+
+    tables[key] = table;
+    return table;
+}
+
+EmissionTable::EmissionTable(G4int Z, G4int A, G4double excitation, G4int nbOfDecays)
+    : fZ(Z), fA(A), fExcitation(excitation), fNbOfDecays(nbOfDecays)
+{}
+
+G4String EmissionTable::GetHeader() const
+{
+    // Anything the sampled decays depend on
+    std::ostringstream header;
+    header << "absorber emission table 2\n" << G4Version << '\n';
+    auto data = std::getenv("G4RADIOACTIVEDATA");
+    header << (data ? data : "") << '\n';
+    header << G4HadronicParameters::Instance()->GetTimeThresholdForRadioactiveDecay() / ns << '\n';
+
+    // The nuclei out of the limits do not decay, the chain stops there;
+    // the decays also depend on the volumes where they are allowed
+    if (auto process = FindRadioactiveDecay())
+    {
+        auto limits = process->GetNucleusLimits();
+        header << "limits " << limits.GetZMin() << ' ' << limits.GetZMax() << ' '
+            << limits.GetAMin() << ' ' << limits.GetAMax() << '\n';
+        header << "volumes";
+        if (process->*RadioactiveDecayVolumes::allVolumes)
+        {
+            header << " all";
+        }
+        else
+        {
+            for (const auto& volume : process->*RadioactiveDecayVolumes::volumes) header << ' ' << volume;
+        }
+        header << '\n';
+    }
+    header << fZ << ' ' << fA << ' ' << std::lround(fExcitation / eV) << ' ' << fNbOfDecays << '\n';
+    return header.str();
+}
+
+G4bool EmissionTable::Load(const G4String& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file) return false;
+
+    // The header must match line by line
+    std::istringstream header(GetHeader());
+    std::string expected, line;
+    while (std::getline(header, expected))
+    {
+        if (!std::getline(file, line) || line != expected) return false;
+    }
+
+    std::size_t nbOfEntries = 0;
+    if (!(file >> nbOfEntries)) return false;
+
+    auto particleTable = G4ParticleTable::GetParticleTable();
+    std::vector<G4double> counts;
+    std::vector<Entry> entries(nbOfEntries);
+
+    for (auto& entry : entries)
+    {
+        G4double count = 0.0;
+        std::size_t nbOfLines = 0;
+        if (!(file >> count >> nbOfLines)) return false;
+
+        entry.lines.resize(nbOfLines);
+        for (auto& emission : entry.lines)
+        {
+            G4double ekin = 0.0;
+            if (!(file >> emission.pdg >> ekin)) return false;
+            emission.ekin = ekin * MeV;
+            emission.particle = particleTable->FindParticle(emission.pdg);
+            if (!emission.particle) return false;
+        }
+
+        std::size_t nbOfContinua = 0;
+        if (!(file >> nbOfContinua)) return false;
+        entry.continua.resize(nbOfContinua);
+        for (auto& continuum : entry.continua)
+        {
+            G4double sharedEnergy = 0.0, maxEnergy = 0.0;
+            std::size_t nbOfBins = 0;
+            if (!(file >> continuum.pdg >> continuum.partner >> sharedEnergy >> maxEnergy >> nbOfBins))
+            {
+                return false;
+            }
+            if (continuum.partner >= static_cast<G4int>(nbOfContinua)) return false;
+            continuum.sharedEnergy = sharedEnergy * MeV;
+            continuum.maxEnergy = maxEnergy * MeV;
+            continuum.particle = particleTable->FindParticle(continuum.pdg);
+            if (!continuum.particle) return false;
+
+            continuum.counts.resize(nbOfBins);
+            for (auto& binCount : continuum.counts)
+            {
+                if (!(file >> binCount)) return false;
+            }
+            if (continuum.partner < 0)
+            {
+                if (continuum.counts.empty()) return false;
+                continuum.aliasTable.Build(continuum.counts);
+            }
+        }
+        counts.push_back(count);
+    }
+
+    if (entries.empty()) return false;
+
+    fEntries = std::move(entries);
+    fCounts = counts;
+    fAliasTable.Build(fCounts);
+    G4cout << "Emission table of Z=" << fZ << " A=" << fA << " read from " << fileName
+        << " (" << fEntries.size() << " entries)" << G4endl;
+    return true;
+}
+
+void EmissionTable::Save(const G4String& fileName) const
+{
+    auto write = [this](std::ostream& file)
+    {
+        file << GetHeader();
+        file.precision(std::numeric_limits<G4double>::max_digits10);
+
+        // Each entry keeps its probability as a count of decays, its
+        // lines, then its continua one per line
+        file << fEntries.size() << '\n';
+        for (std::size_t i = 0; i < fEntries.size(); i++)
+        {
+            const auto& entry = fEntries[i];
+            file << fCounts[i] << ' ' << entry.lines.size();
+            for (const auto& emission : entry.lines)
+            {
+                file << ' ' << emission.pdg << ' ' << emission.ekin / MeV;
+            }
+            file << ' ' << entry.continua.size() << '\n';
+
+            for (const auto& continuum : entry.continua)
+            {
+                file << continuum.pdg << ' ' << continuum.partner << ' ' << continuum.sharedEnergy / MeV
+                    << ' ' << continuum.maxEnergy / MeV << ' ' << continuum.counts.size();
+                for (auto binCount : continuum.counts) file << ' ' << binCount;
+                file << '\n';
+            }
+        }
+        return static_cast<G4bool>(file);
+    };
+
+    if (!CacheFiles::Write(fileName, write))
+    {
+        G4cout << "Warning: emission table could not be written to " << fileName << G4endl;
+    }
+}
+
+void EmissionTable::Sample(Decay& decay) const
+{
+    const auto& entry = fEntries[fAliasTable.Sample(G4UniformRand(), G4UniformRand())];
+    decay = entry.lines;
+
+    // Beta particles from their spectra first, then their neutrinos
+    auto first = decay.size();
+    for (const auto& continuum : entry.continua)
+    {
+        G4double ekin = 0.0;
+        if (continuum.partner < 0)
+        {
+            auto bin = continuum.aliasTable.Sample(G4UniformRand(), G4UniformRand());
+            ekin = (bin + G4UniformRand()) * continuum.maxEnergy / continuum.counts.size();
+        }
+        decay.push_back({ continuum.particle, continuum.pdg, ekin });
+    }
+    for (std::size_t i = 0; i < entry.continua.size(); i++)
+    {
+        const auto& continuum = entry.continua[i];
+        if (continuum.partner < 0) continue;
+        decay[first + i].ekin = std::max(0.0, continuum.sharedEnergy - decay[first + continuum.partner].ekin);
+    }
+}
+
+G4bool EmissionTable::Tabulate()
+{
+    auto process = FindRadioactiveDecay();
+    auto ion = G4IonTable::GetIonTable()->GetIon(fZ, fA, fExcitation);
+    if (!process || !ion)
+    {
+        G4cout << "Warning: no radioactive decay to tabulate the emissions of Z=" << fZ
+            << " A=" << fA << G4endl;
+        return false;
+    }
+
+    // Out of the selected volumes the decays are not done, and in them
+    // they need the volume of the track, which the table does not have
+    if (!(process->*RadioactiveDecayVolumes::allVolumes))
+    {
+        G4cout << "Warning: the radioactive decay is restricted to some volumes, the emissions of Z="
+            << fZ << " A=" << fA << " are not tabulated." << G4endl;
+        return false;
+    }
+
+    // Daughters decay as in the transport: not beyond the threshold for
+    // very long decay times
+    auto threshold = G4HadronicParameters::Instance()->GetTimeThresholdForRadioactiveDecay();
+
+    // Decays with the same lines and the same kinds of continua are
+    // counted in one entry, which collects the energies of its continua
+    struct Accumulator
+    {
+        Entry entry;
+        G4double count{ 0.0 };
+        std::vector<std::vector<G4double>> energies;
+        std::vector<G4double> sharedSums;
+    };
+    std::map<std::vector<std::pair<G4int, G4double>>, Accumulator> accumulators;
+
+    // The decays are sampled with an engine of their own, seeded from the
+    // nuclide: the table is reproducible and the run engine is untouched
+    auto runEngine = G4Random::getTheEngine();
+    CLHEP::MixMaxRng engine(static_cast<long>(1000 * fZ + fA) * 1000003L
+        + std::lround(fExcitation / eV));
+    G4Random::setTheEngine(&engine);
+
+    Decay lines;
+    std::vector<Continuum> continua;
+    std::vector<G4double> energies;
+    Decay products;
+
+    for (G4int i = 0; i < fNbOfDecays; i++)
+    {
+        lines.clear();
+        continua.clear();
+        energies.clear();
+        std::vector<const G4ParticleDefinition*> nuclei{ ion };
+        G4int nbOfSteps = 0;
+
+        while (!nuclei.empty() && nbOfSteps++ < maxNbOfSteps)
+        {
+            auto nucleus = nuclei.back();
+            nuclei.pop_back();
+            if (nucleus != ion && nucleus->GetPDGLifeTime() > threshold) continue;
+
+            // Decay at rest, without any tracking
+            G4Track track(new G4DynamicParticle(nucleus, G4ThreeVector(0.0, 0.0, 1.0), 0.0),
+                0.0, G4ThreeVector());
+            G4Step step;
+            track.SetStep(&step);
+
+            products.clear();
+            auto change = process->AtRestDoIt(track, step);
+            for (G4int j = 0; j < change->GetNumberOfSecondaries(); j++)
+            {
+                auto secondary = change->GetSecondary(j);
+                auto particle = secondary->GetDefinition();
+                if (particle->IsGeneralIon())
+                {
+                    nuclei.push_back(particle);
+                }
+                else
+                {
+                    products.push_back({ particle, particle->GetPDGEncoding(),
+                        secondary->GetKineticEnergy() });
+                }
+                delete secondary;
+            }
+            change->Clear();
+
+            // A beta decay emits its particle with its neutrino: an
+            // electron with an electron antineutrino, or a positron with
+            // an electron neutrino; the other emissions are lines
+            G4int betaPdg = 0, neutrinoPdg = 0;
+            for (const auto& product : products)
+            {
+                if (product.pdg == -12)
+                {
+                    betaPdg = 11;
+                    neutrinoPdg = -12;
+                }
+                else if (product.pdg == -11)
+                {
+                    betaPdg = -11;
+                    neutrinoPdg = 12;
+                }
+            }
+            G4int betaIndex = -1;
+            for (const auto& product : products)
+            {
+                if (betaPdg != 0 && betaIndex < 0 && product.pdg == betaPdg)
+                {
+                    betaIndex = static_cast<G4int>(continua.size());
+                    continua.push_back({ product.particle, product.pdg });
+                    energies.push_back(product.ekin);
+                }
+                else if (neutrinoPdg == 0 || product.pdg != neutrinoPdg)
+                {
+                    lines.push_back(product);
+                }
+            }
+            for (const auto& product : products)
+            {
+                if (neutrinoPdg != 0 && product.pdg == neutrinoPdg)
+                {
+                    continua.push_back({ product.particle, product.pdg, betaIndex });
+                    energies.push_back(product.ekin);
+                }
+            }
+        }
+
+        std::sort(lines.begin(), lines.end(), [](const Emission& a, const Emission& b)
+            { return a.pdg != b.pdg ? a.pdg < b.pdg : a.ekin < b.ekin; });
+
+        // Key: the lines, then the kinds of the continua
+        std::vector<std::pair<G4int, G4double>> key;
+        for (const auto& emission : lines) key.emplace_back(emission.pdg, emission.ekin);
+        key.emplace_back(0, -1.0);
+        for (const auto& continuum : continua) key.emplace_back(continuum.pdg, continuum.partner);
+
+        auto& accumulator = accumulators[key];
+        if (accumulator.count == 0.0)
+        {
+            accumulator.entry.lines = lines;
+            accumulator.entry.continua = continua;
+            accumulator.energies.resize(continua.size());
+            accumulator.sharedSums.resize(continua.size(), 0.0);
+        }
+        accumulator.count += 1.0;
+        for (std::size_t k = 0; k < continua.size(); k++)
+        {
+            if (continua[k].partner < 0)
+            {
+                accumulator.energies[k].push_back(energies[k]);
+            }
+            else
+            {
+                accumulator.sharedSums[k] += energies[k] + energies[continua[k].partner];
+            }
+        }
+    }
+
+    G4Random::setTheEngine(runEngine);
+
+    std::vector<G4double> counts;
+    fEntries.clear();
+    for (auto& [key, accumulator] : accumulators)
+    {
+        auto& entry = accumulator.entry;
+        for (std::size_t k = 0; k < entry.continua.size(); k++)
+        {
+            auto& continuum = entry.continua[k];
+            if (continuum.partner >= 0)
+            {
+                continuum.sharedEnergy = accumulator.sharedSums[k] / accumulator.count;
+                continue;
+            }
+
+            const auto& values = accumulator.energies[k];
+            continuum.maxEnergy = *std::max_element(values.begin(), values.end());
+            continuum.counts.assign(kNbOfBins, 0.0);
+            for (auto ekin : values)
+            {
+                auto bin = (continuum.maxEnergy > 0.0)
+                    ? static_cast<G4int>(kNbOfBins * ekin / continuum.maxEnergy) : 0;
+                continuum.counts[std::min(bin, kNbOfBins - 1)] += 1.0;
+            }
+            continuum.aliasTable.Build(continuum.counts);
+        }
+        fEntries.push_back(std::move(entry));
+        counts.push_back(accumulator.count);
+    }
+
+    if (fEntries.empty())
+    {
+        G4cout << "Warning: Z=" << fZ << " A=" << fA << " does not decay." << G4endl;
+        return false;
+    }
+
+    fCounts = counts;
+    fAliasTable.Build(fCounts);
+    G4cout << "Emission table of Z=" << fZ << " A=" << fA << " tabulated with "
+        << fNbOfDecays << " decays (" << fEntries.size() << " entries)" << G4endl;
+    return true;
+}
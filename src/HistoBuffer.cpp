@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/HistoBuffer.cpp
+/// \brief Implementation of the HistoBuffer class
+
+#include "HistoBuffer.h"
+
+#include "tools/histo/h1d"
+
+#include <algorithm>
+
+G4bool HistoBuffer::Configure(const tools::histo::h1d* h1, G4double unit, G4bool identityFcn)
+{
+    fNbins = 0;
+    fBins.clear();
+    fEventSw.clear();
+    fTouched.clear();
+
+    if (!h1 || !identityFcn || unit <= 0.0) return false;
+
+    const auto& axis = h1->axis();
+    if (!axis.is_fixed_bin() || axis.bins() == 0) return false;
+
+    fNbins = axis.bins();
+    fXmin = axis.lower_edge();
+    fXmax = axis.upper_edge();
+    fInvWidth = fNbins / (fXmax - fXmin);
+    fInvUnit = 1.0 / unit;
+    fBins.assign(fNbins + 2, Bin());
+    fEventSw.assign(fNbins + 2, 0.0);
+
+    return true;
+}
+
+void HistoBuffer::Reset()
+{
+    std::fill(fBins.begin(), fBins.end(), Bin());
+}
+
+G4double HistoBuffer::EndOfEvent()
+{
+    G4double total = 0.0;
+    for (auto ibin : fTouched)
+    {
+        G4double sw = fEventSw[ibin];
+        fBins[ibin].sw2 += sw * sw;
+        if (ibin > 0 && ibin <= static_cast<std::size_t>(fNbins)) total += sw;
+        fEventSw[ibin] = 0.0;
+    }
+    fTouched.clear();
+
+    return total;
+}
+
+void HistoBuffer::FlushTo(tools::histo::h1d* h1)
+{
+    if (!h1 || fBins.empty()) return;
+
+    const auto& entries = h1->bins_entries();
+    const auto& sw = h1->bins_sum_w();
+    const auto& sw2 = h1->bins_sum_w2();
+    const auto& sxw = h1->bins_sum_xw();
+    const auto& sx2w = h1->bins_sum_x2w();
+
+    for (std::size_t ibin = 0; ibin < fBins.size(); ibin++)
+    {
+        const auto& bin = fBins[ibin];
+        if (bin.entries == 0.0) continue;
+
+        h1->set_bin_content(ibin,
+            entries[ibin] + static_cast<unsigned int>(bin.entries),
+            sw[ibin] + bin.sw,
+            sw2[ibin] + bin.sw2,
+            sxw[ibin][0] + bin.sxw,
+            sx2w[ibin][0] + bin.sx2w);
+    }
+
+    Reset();
+}
@@ -0,0 +1,184 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/InitializationMonitor.cpp
+/// \brief Implementation of the InitializationMonitor class
+
+#include "InitializationMonitor.h"
+
+#include "G4StateManager.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+G4double InitializationMonitor::fKernelInitTime = 0.0;
+G4double InitializationMonitor::fRunInitTime = 0.0;
+G4double InitializationMonitor::fWorkerInitTime = 0.0;
+G4Mutex InitializationMonitor::fWorkerMutex = G4MUTEX_INITIALIZER;
+
+InitializationMonitor::InitializationMonitor(const G4String& physicsListName)
+    : fPhysicsListName(physicsListName)
+{}
+
+G4bool InitializationMonitor::Notify(G4ApplicationState requestedState)
+{
+    auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+
+    if (requestedState == G4State_Init && currentState != G4State_Init)
+    {
+        fTimer.Start();
+    }
+    else if (requestedState == G4State_Idle && currentState == G4State_Init)
+    {
+        // The first initialization is the one of the kernel, the second
+        // one prepares the first run
+        fTimer.Stop();
+        fNbOfInits++;
+        if (fNbOfInits == 1)
+        {
+            fKernelInitTime = fTimer.GetRealElapsed();
+            Report("master kernel initialization", true);
+        }
+        if (fNbOfInits == 2)
+        {
+            fRunInitTime = fTimer.GetRealElapsed();
+            Report("master first run initialization", true);
+        }
+    }
+    else if (requestedState == G4State_Idle && currentState == G4State_GeomClosed
+        && !fRunReported)
+    {
+        fRunReported = true;
+        Report("end of the first run", false);
+
+        auto workerInitTime = GetWorkerInitTime();
+        if (workerInitTime > 0.0)
+        {
+            G4cout
+                << " Physics list " << fPhysicsListName << ", worker initialization: "
+                << std::setprecision(3) << workerInitTime << " s (slowest thread)"
+                << std::setprecision(6) << G4endl;
+        }
+    }
+
+    return true;
+}
+
+void InitializationMonitor::AddWorkerInitTime(G4double time)
+{
+    G4AutoLock lock(&fWorkerMutex);
+    fWorkerInitTime = std::max(fWorkerInitTime, time);
+}
+
+G4double InitializationMonitor::GetWorkerInitTime()
+{
+    G4AutoLock lock(&fWorkerMutex);
+    return fWorkerInitTime;
+}
+
+void InitializationMonitor::Report(const char* step, G4bool timed) const
+{
+    constexpr G4double megabyte = 1024. * 1024.;
+
+    G4cout << " Physics list " << fPhysicsListName << ", " << step << ":";
+    if (timed)
+    {
+        G4cout << " " << std::setprecision(3) << fTimer.GetRealElapsed() << " s,";
+    }
+    G4cout
+        << " resident memory " << std::setprecision(4) << GetResidentMemory() / megabyte
+        << " MB (peak " << GetPeakMemory() / megabyte << " MB)"
+        << std::setprecision(6) << G4endl;
+}
+
+#if defined(_WIN32)
+
+std::size_t InitializationMonitor::GetResidentMemory()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+}
+
+std::size_t InitializationMonitor::GetPeakMemory()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+}
+
+#elif defined(__linux__)
+
+std::size_t InitializationMonitor::GetResidentMemory()
+{
+    // Second field of statm, in pages
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (!(statm >> size >> resident)) return 0;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::size_t InitializationMonitor::GetPeakMemory()
+{
+    // VmHWM line of status, in kB
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stoul(line.substr(6)) * 1024;
+    }
+    return 0;
+}
+
+#else
+
+std::size_t InitializationMonitor::GetResidentMemory()
+{
+    return 0;
+}
+
+std::size_t InitializationMonitor::GetPeakMemory()
+{
+    // The peak is in bytes on macOS
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<std::size_t>(usage.ru_maxrss);
+}
+
+#endif
@@ -0,0 +1,145 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/IsotopeSource.cpp
+/// \brief Implementation of the IsotopeSource class
+
+#include "IsotopeSource.h"
+#include "IsotopeSourceMessenger.h"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4IonTable.hh"
+#include "G4Threading.hh"
+#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+IsotopeSource::IsotopeSource()
+{
+    fMessenger = new IsotopeSourceMessenger(this);
+}
+
+IsotopeSource::~IsotopeSource()
+{
+    delete fMessenger;
+}
+
+void IsotopeSource::AddNuclide(G4int Z, G4int A, G4double activity, G4double excitation)
+{
+    Nuclide nuclide;
+    nuclide.Z = Z;
+    nuclide.A = A;
+    nuclide.activity = activity;
+    nuclide.excitation = excitation;
+    fNuclides.push_back(nuclide);
+    fPrepared = false;
+}
+
+void IsotopeSource::ClearNuclides()
+{
+    fNuclides.clear();
+    fPrepared = false;
+}
+
+void IsotopeSource::Prepare()
+{
+    fPrepared = true;
+    if (fNuclides.empty() && G4Threading::IsMasterThread())
+    {
+        G4cout << "Warning: the isotope source has no nuclide." << G4endl;
+    }
+
+    std::vector<G4double> activities;
+    for (auto& nuclide : fNuclides)
+    {
+        // Ions can only be made once the physics is built
+        nuclide.ion = G4IonTable::GetIonTable()->GetIon(nuclide.Z, nuclide.A, nuclide.excitation);
+        if (!nuclide.ion)
+        {
+            G4cout << "Warning: unknown nuclide Z=" << nuclide.Z << " A=" << nuclide.A
+                << " in the isotope source." << G4endl;
+        }
+
+        nuclide.emissionTable.reset();
+        if (fEmissionTables && nuclide.ion)
+        {
+            nuclide.emissionTable = EmissionTable::Get(nuclide.Z, nuclide.A,
+                nuclide.excitation, fNbOfTabulatedDecays);
+        }
+
+        activities.push_back(nuclide.ion ? nuclide.activity : 0.0);
+    }
+
+    fNuclideTable.Build(activities);
+}
+
+G4ThreeVector IsotopeSource::SamplePosition() const
+{
+    if (fShape == kPoint) return fCentre;
+
+    G4double r = fRadius * std::sqrt(G4UniformRand());
+    G4double phi = twopi * G4UniformRand();
+    G4double z = (fShape == kCylinder) ? fHalfLength * (2.0 * G4UniformRand() - 1.0) : 0.0;
+    return fCentre + G4ThreeVector(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+void IsotopeSource::GeneratePrimaryVertex(G4Event* anEvent)
+{
+    if (!fPrepared) Prepare();
+    if (fNuclides.empty()) return;
+
+    const auto& nuclide = fNuclides[fNuclideTable.Sample(G4UniformRand(), G4UniformRand())];
+    if (!nuclide.ion) return;
+
+    if (nuclide.emissionTable)
+    {
+        nuclide.emissionTable->Sample(fDecay);
+        if (fDecay.empty()) return;
+
+        auto vertex = new G4PrimaryVertex(SamplePosition(), 0.0);
+        for (const auto& emission : fDecay)
+        {
+            auto primary = new G4PrimaryParticle(emission.particle);
+            primary->SetKineticEnergy(emission.ekin);
+            primary->SetMomentumDirection(G4RandomDirection());
+            vertex->SetPrimary(primary);
+        }
+        anEvent->AddPrimaryVertex(vertex);
+        return;
+    }
+
+    // Ion at rest, decayed by the physics
+    auto vertex = new G4PrimaryVertex(SamplePosition(), 0.0);
+    auto primary = new G4PrimaryParticle(nuclide.ion);
+    primary->SetKineticEnergy(0.0);
+    primary->SetMomentumDirection(G4ThreeVector(0.0, 0.0, 1.0));
+    vertex->SetPrimary(primary);
+    anEvent->AddPrimaryVertex(vertex);
+}
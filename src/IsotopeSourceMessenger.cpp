@@ -0,0 +1,166 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/IsotopeSourceMessenger.cpp
+/// \brief Implementation of the IsotopeSourceMessenger class
+
+#include "IsotopeSourceMessenger.h"
+#include "IsotopeSource.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+
+#include <sstream>
+
+IsotopeSourceMessenger::IsotopeSourceMessenger(IsotopeSource* source)
+    : fSource(source)
+{
+    fDirectory = new G4UIdirectory("/src/iso/");
+    fDirectory->SetGuidance("Isotope source (/src/mode iso).");
+
+    fShapeCmd = new G4UIcmdWithAString("/src/iso/shape", this);
+    fShapeCmd->SetGuidance("Select the shape of the source:");
+    fShapeCmd->SetGuidance("  point    : at the centre,");
+    fShapeCmd->SetGuidance("  disk     : uniform disk normal to z,");
+    fShapeCmd->SetGuidance("  cylinder : uniform cylinder along z.");
+    fShapeCmd->SetParameterName("shape", false);
+    fShapeCmd->SetCandidates("point disk cylinder");
+    fShapeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCentreCmd = new G4UIcmdWith3VectorAndUnit("/src/iso/centre", this);
+    fCentreCmd->SetGuidance("Set the centre of the source.");
+    fCentreCmd->SetParameterName("x", "y", "z", false);
+    fCentreCmd->SetUnitCategory("Length");
+    fCentreCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRadiusCmd = new G4UIcmdWithADoubleAndUnit("/src/iso/radius", this);
+    fRadiusCmd->SetGuidance("Set the radius of a disk or cylinder source.");
+    fRadiusCmd->SetParameterName("radius", false);
+    fRadiusCmd->SetRange("radius>=0.");
+    fRadiusCmd->SetUnitCategory("Length");
+    fRadiusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fHalfLengthCmd = new G4UIcmdWithADoubleAndUnit("/src/iso/halfLength", this);
+    fHalfLengthCmd->SetGuidance("Set the half length along z of a cylinder source.");
+    fHalfLengthCmd->SetParameterName("halfLength", false);
+    fHalfLengthCmd->SetRange("halfLength>=0.");
+    fHalfLengthCmd->SetUnitCategory("Length");
+    fHalfLengthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAddNuclideCmd = new G4UIcommand("/src/iso/addNuclide", this);
+    fAddNuclideCmd->SetGuidance("Add a nuclide to the source, with its activity in Bq.");
+    fAddNuclideCmd->SetGuidance("Each event decays one nuclide, sampled from the activities.");
+    auto zPrm = new G4UIparameter("Z", 'i', false);
+    zPrm->SetParameterRange("Z>0");
+    fAddNuclideCmd->SetParameter(zPrm);
+    auto aPrm = new G4UIparameter("A", 'i', false);
+    aPrm->SetParameterRange("A>0");
+    fAddNuclideCmd->SetParameter(aPrm);
+    auto activityPrm = new G4UIparameter("activity", 'd', false);
+    activityPrm->SetParameterRange("activity>0.");
+    fAddNuclideCmd->SetParameter(activityPrm);
+    auto excitationPrm = new G4UIparameter("excitation", 'd', true);
+    excitationPrm->SetDefaultValue(0.0);
+    fAddNuclideCmd->SetParameter(excitationPrm);
+    auto unitPrm = new G4UIparameter("unit", 's', true);
+    unitPrm->SetDefaultUnit("keV");
+    fAddNuclideCmd->SetParameter(unitPrm);
+    fAddNuclideCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fClearNuclidesCmd = new G4UIcmdWithoutParameter("/src/iso/clearNuclides", this);
+    fClearNuclidesCmd->SetGuidance("Remove all nuclides of the source.");
+    fClearNuclidesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEmissionTablesCmd = new G4UIcmdWithABool("/src/iso/emissionTables", this);
+    fEmissionTablesCmd->SetGuidance("Emit the particles of tabulated decays instead of the ions");
+    fEmissionTablesCmd->SetGuidance("(see /src/tabulatedDecays).");
+    fEmissionTablesCmd->SetParameterName("value", false);
+    fEmissionTablesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+IsotopeSourceMessenger::~IsotopeSourceMessenger()
+{
+    delete fShapeCmd;
+    delete fCentreCmd;
+    delete fRadiusCmd;
+    delete fHalfLengthCmd;
+    delete fAddNuclideCmd;
+    delete fClearNuclidesCmd;
+    delete fEmissionTablesCmd;
+    delete fDirectory;
+}
+
+void IsotopeSourceMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fShapeCmd)
+    {
+        auto shape = IsotopeSource::kPoint;
+        if (newValue == "disk") shape = IsotopeSource::kDisk;
+        if (newValue == "cylinder") shape = IsotopeSource::kCylinder;
+        fSource->SetShape(shape);
+    }
+
+    if (command == fCentreCmd)
+    {
+        fSource->SetCentre(fCentreCmd->GetNew3VectorValue(newValue));
+    }
+
+    if (command == fRadiusCmd)
+    {
+        fSource->SetRadius(fRadiusCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fHalfLengthCmd)
+    {
+        fSource->SetHalfLength(fHalfLengthCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fAddNuclideCmd)
+    {
+        G4int Z = 0, A = 0;
+        G4double activity = 0.0, excitation = 0.0;
+        G4String unit;
+        std::istringstream is(newValue);
+        is >> Z >> A >> activity >> excitation >> unit;
+        fSource->AddNuclide(Z, A, activity, excitation * G4UIcommand::ValueOf(unit));
+    }
+
+    if (command == fClearNuclidesCmd)
+    {
+        fSource->ClearNuclides();
+    }
+
+    if (command == fEmissionTablesCmd)
+    {
+        fSource->SetEmissionTables(fEmissionTablesCmd->GetNewBoolValue(newValue));
+    }
+}
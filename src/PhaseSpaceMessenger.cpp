@@ -0,0 +1,127 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PhaseSpaceMessenger.cpp
+/// \brief Implementation of the PhaseSpaceMessenger class
+
+#include "PhaseSpaceMessenger.h"
+#include "PhaseSpaceWriter.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+PhaseSpaceMessenger::PhaseSpaceMessenger(PhaseSpaceWriter* writer)
+    : fWriter(writer)
+{
+    fDirectory = new G4UIdirectory("/phsp/");
+    fDirectory->SetGuidance("Phase space output of the particles entering the detector.");
+
+    fWriteCmd = new G4UIcmdWithABool("/phsp/write", this);
+    fWriteCmd->SetGuidance("Write the particles entering the detector, one file");
+    fWriteCmd->SetGuidance("per run and per thread: <analysis file>_run<id>_t<thread>.phsp");
+    fWriteCmd->SetParameterName("write", false);
+    fWriteCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBlockSizeCmd = new G4UIcmdWithAnInteger("/phsp/blockSize", this);
+    fBlockSizeCmd->SetGuidance("Set the number of records of a block.");
+    fBlockSizeCmd->SetParameterName("nb", false);
+    fBlockSizeCmd->SetRange("nb>0");
+    fBlockSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCompressionLevelCmd = new G4UIcmdWithAnInteger("/phsp/compressionLevel", this);
+    fCompressionLevelCmd->SetGuidance("Set the zlib compression level (0: none, 9: best).");
+    fCompressionLevelCmd->SetParameterName("level", false);
+    fCompressionLevelCmd->SetRange("level>=0 && level<=9");
+    fCompressionLevelCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPlaneCmd = new G4UIcmdWithAString("/phsp/plane", this);
+    fPlaneCmd->SetGuidance("Select where the particles are recorded:");
+    fPlaneCmd->SetGuidance("  detector  : when entering the detector,");
+    fPlaneCmd->SetGuidance("  stackExit : when crossing the exit face of the absorber stack,");
+    fPlaneCmd->SetGuidance("              they are then killed (file for /src/mode phsp).");
+    fPlaneCmd->SetParameterName("plane", false);
+    fPlaneCmd->SetCandidates("detector stackExit");
+    fPlaneCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPlaneZCmd = new G4UIcmdWithADoubleAndUnit("/phsp/planeZ", this);
+    fPlaneZCmd->SetGuidance("Record and kill the particles crossing the plane z = value");
+    fPlaneZCmd->SetGuidance("in the forward direction.");
+    fPlaneZCmd->SetParameterName("z", false);
+    fPlaneZCmd->SetUnitCategory("Length");
+    fPlaneZCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+PhaseSpaceMessenger::~PhaseSpaceMessenger()
+{
+    delete fWriteCmd;
+    delete fBlockSizeCmd;
+    delete fCompressionLevelCmd;
+    delete fPlaneCmd;
+    delete fPlaneZCmd;
+    delete fDirectory;
+}
+
+void PhaseSpaceMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fWriteCmd)
+    {
+        fWriter->SetEnabled(fWriteCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fBlockSizeCmd)
+    {
+        fWriter->SetBlockSize(fBlockSizeCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fCompressionLevelCmd)
+    {
+        fWriter->SetCompressionLevel(fCompressionLevelCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fPlaneCmd)
+    {
+        fWriter->SetPlaneMode(newValue == "stackExit"
+            ? PhaseSpaceWriter::kStackExit
+            : PhaseSpaceWriter::kDetectorEntry);
+    }
+
+    if (command == fPlaneZCmd)
+    {
+        fWriter->SetPlaneZ(fPlaneZCmd->GetNewDoubleValue(newValue));
+    }
+}
+
+G4String PhaseSpaceMessenger::GetCurrentValue(G4UIcommand* command)
+{
+    if (command == fWriteCmd)
+    {
+        return fWriteCmd->ConvertToString(fWriter->IsEnabled());
+    }
+    return "";
+}
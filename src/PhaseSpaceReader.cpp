@@ -0,0 +1,316 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PhaseSpaceReader.cpp
+/// \brief Implementation of the PhaseSpaceReader class
+
+#include "PhaseSpaceReader.h"
+#include "PhaseSpaceWriter.h"
+
+#include "G4AutoLock.hh"
+
+#include <cstring>
+
+#ifdef ABSORBER_USE_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::uint32_t ReadUInt32(const unsigned char* data)
+{
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Column of a block: inflated if needed, then unshuffled into values
+template <typename T>
+G4bool DecodeColumn(const unsigned char*& data, const unsigned char* end,
+    std::uint32_t count, std::vector<T>& values)
+{
+    if (end - data < 8) return false;
+    std::uint32_t rawSize = ReadUInt32(data);
+    std::uint32_t storedSize = ReadUInt32(data + 4);
+    data += 8;
+    if (rawSize != count * sizeof(T) || static_cast<std::size_t>(end - data) < storedSize) return false;
+
+    std::vector<unsigned char> shuffled(rawSize);
+    if (storedSize == rawSize)
+    {
+        if (rawSize > 0) std::memcpy(shuffled.data(), data, rawSize);
+    }
+    else
+    {
+#ifdef ABSORBER_USE_ZLIB
+        uLongf size = rawSize;
+        if (uncompress(shuffled.data(), &size, data, storedSize) != Z_OK || size != rawSize) return false;
+#else
+        return false;
+#endif
+    }
+    data += storedSize;
+
+    values.resize(count);
+    auto bytes = reinterpret_cast<unsigned char*>(values.data());
+    for (std::size_t k = 0; k < sizeof(T); k++)
+    {
+        for (std::size_t i = 0; i < count; i++) bytes[i * sizeof(T) + k] = shuffled[k * count + i];
+    }
+    return true;
+}
+}
+
+struct PhaseSpaceReader::MappedFile
+{
+    const unsigned char* data{ nullptr };
+    std::size_t size{ 0 };
+#if defined(_WIN32)
+    HANDLE file{ INVALID_HANDLE_VALUE };
+    HANDLE mapping{ nullptr };
+#endif
+
+    G4bool Map(const G4String& fileName)
+    {
+#if defined(_WIN32)
+        file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return false;
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) return false;
+        data = static_cast<const unsigned char*>(address);
+#endif
+        return data != nullptr;
+    }
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+};
+
+PhaseSpaceReader::PhaseSpaceReader() = default;
+
+PhaseSpaceReader::~PhaseSpaceReader() = default;
+
+PhaseSpaceReader* PhaseSpaceReader::Instance()
+{
+    static PhaseSpaceReader instance;
+    return &instance;
+}
+
+G4bool PhaseSpaceReader::Open(const std::vector<G4String>& fileNames)
+{
+    G4AutoLock lock(&fMutex);
+    if (fileNames == fFileNames && !fBlocks.empty()) return true;
+
+    fBlocks.clear();
+    fFiles.clear();
+    fFileNames = fileNames;
+    fNextBlock = 0;
+    fRunID = -1;
+    fWithHistories = true;
+    fNbOfHistories = 0;
+    fTotalHistories = 0;
+
+    for (const auto& fileName : fileNames)
+    {
+        auto file = std::make_unique<MappedFile>();
+        G4bool withHistories = false;
+        auto nbOfBlocks = fBlocks.size();
+        auto totalHistories = fTotalHistories;
+        if (!file->Map(fileName) || !Index(*file, withHistories))
+        {
+            // Nothing of a file which is unmapped again
+            fBlocks.resize(nbOfBlocks);
+            fTotalHistories = totalHistories;
+            G4cout << "Warning: " << fileName << " is not a readable phase space file." << G4endl;
+            continue;
+        }
+        if (!withHistories)
+        {
+            G4cout << "Warning: " << fileName << " does not give its number of histories,"
+                << " the replay is normalized to its own events." << G4endl;
+            fWithHistories = false;
+        }
+        fFiles.push_back(std::move(file));
+    }
+
+    return !fBlocks.empty();
+}
+
+G4bool PhaseSpaceReader::Index(const MappedFile& file, G4bool& withHistories)
+{
+    // Header, then the blocks up to the empty one; the blocks of the
+    // former layout have no number of histories
+    constexpr std::size_t headerSize = 16;
+    if (file.size < headerSize) return false;
+    withHistories = std::memcmp(file.data, "ABSPHSP2", 8) == 0;
+    if (!withHistories && std::memcmp(file.data, "ABSPHSP1", 8) != 0) return false;
+    if (ReadUInt32(file.data + 8) != PhaseSpaceWriter::kNbOfColumns) return false;
+
+    std::size_t blockHeaderSize = withHistories ? 8 : 4;
+    std::size_t firstBlock = fBlocks.size();
+    std::size_t offset = headerSize;
+    while (offset + blockHeaderSize <= file.size)
+    {
+        BlockRef block;
+        block.data = file.data + offset;
+        block.headerSize = blockHeaderSize;
+        block.nbOfRecords = ReadUInt32(block.data);
+        if (withHistories) block.nbOfHistories = ReadUInt32(block.data + 4);
+
+        // All the histories of the file, whether or not it has blocks
+        fTotalHistories += block.nbOfHistories;
+        if (block.nbOfRecords == 0)
+        {
+            // The histories after the last block go with it, for the
+            // runs taking only some of the blocks
+            if (fBlocks.size() > firstBlock) fBlocks.back().nbOfHistories += block.nbOfHistories;
+            return true;
+        }
+
+        std::size_t end = offset + blockHeaderSize;
+        for (std::uint32_t column = 0; column < PhaseSpaceWriter::kNbOfColumns; column++)
+        {
+            if (end + 8 > file.size) return false;
+            end += 8 + ReadUInt32(file.data + end + 4);
+        }
+        if (end > file.size) return false;
+
+        block.size = end - offset;
+        fBlocks.push_back(block);
+        offset = end;
+    }
+
+    // Truncated file: the complete blocks are kept
+    return true;
+}
+
+G4bool PhaseSpaceReader::NextBlock(G4int runID, std::vector<Record>& records)
+{
+    BlockRef block;
+    {
+        G4AutoLock lock(&fMutex);
+        if (runID != fRunID)
+        {
+            fRunID = runID;
+            fNextBlock = 0;
+            fNbOfHistories = 0;
+        }
+        if (fNextBlock >= fBlocks.size()) return false;
+        block = fBlocks[fNextBlock++];
+        fNbOfHistories += block.nbOfHistories;
+    }
+
+    if (!Decode(block, records))
+    {
+        G4cout << "Warning: corrupted phase space block skipped." << G4endl;
+        records.clear();
+    }
+    return true;
+}
+
+G4long PhaseSpaceReader::GetNbOfHistories(G4int runID, G4bool& complete) const
+{
+    G4AutoLock lock(&fMutex);
+    complete = fNextBlock >= fBlocks.size();
+    if (runID != fRunID || !fWithHistories || fNextBlock == 0) return -1;
+    return complete ? fTotalHistories : fNbOfHistories;
+}
+
+G4bool PhaseSpaceReader::Decode(const BlockRef& block, std::vector<Record>& records) const
+{
+    auto n = block.nbOfRecords;
+    auto data = block.data + block.headerSize;
+    auto end = block.data + block.size;
+
+    std::vector<std::int32_t> pdg, event;
+    std::vector<float> ekin, x, y, z, dx, dy, dz;
+    std::vector<double> weight, time;
+
+    G4bool ok = DecodeColumn(data, end, n, pdg)
+        && DecodeColumn(data, end, n, ekin)
+        && DecodeColumn(data, end, n, x)
+        && DecodeColumn(data, end, n, y)
+        && DecodeColumn(data, end, n, z)
+        && DecodeColumn(data, end, n, dx)
+        && DecodeColumn(data, end, n, dy)
+        && DecodeColumn(data, end, n, dz)
+        && DecodeColumn(data, end, n, weight)
+        && DecodeColumn(data, end, n, event)
+        && DecodeColumn(data, end, n, time);
+    if (!ok) return false;
+
+    records.resize(n);
+    G4int eventID = 0;
+    for (std::uint32_t i = 0; i < n; i++)
+    {
+        auto& record = records[i];
+        eventID += event[i];
+        record.pdg = pdg[i];
+        record.ekin = ekin[i];
+        record.position.set(x[i], y[i], z[i]);
+        record.direction.set(dx[i], dy[i], dz[i]);
+        record.weight = weight[i];
+        record.eventID = eventID;
+        record.time = time[i];
+    }
+    return true;
+}
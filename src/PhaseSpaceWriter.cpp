@@ -0,0 +1,180 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PhaseSpaceWriter.cpp
+/// \brief Implementation of the PhaseSpaceWriter class
+
+#include "PhaseSpaceWriter.h"
+#include "PhaseSpaceMessenger.h"
+
+#ifdef ABSORBER_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+void WriteUInt32(std::ofstream& file, std::uint32_t value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}
+
+void PhaseSpaceWriter::Block::reserve(std::size_t n)
+{
+    pdg.reserve(n);
+    ekin.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    dx.reserve(n);
+    dy.reserve(n);
+    dz.reserve(n);
+    weight.reserve(n);
+    event.reserve(n);
+    time.reserve(n);
+}
+
+PhaseSpaceWriter::PhaseSpaceWriter()
+{
+    fMessenger = new PhaseSpaceMessenger(this);
+}
+
+PhaseSpaceWriter::~PhaseSpaceWriter()
+{
+    Close();
+    delete fMessenger;
+}
+
+G4bool PhaseSpaceWriter::Open(const G4String& fileName)
+{
+    Close();
+
+    fFile.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!fFile)
+    {
+        G4cout << "Warning: cannot open the phase space file " << fileName << G4endl;
+        return false;
+    }
+
+    std::uint32_t flags = 0;
+#ifdef ABSORBER_USE_ZLIB
+    flags |= 1;
+#endif
+    fFile.write("ABSPHSP2", 8);
+    WriteUInt32(fFile, kNbOfColumns);
+    WriteUInt32(fFile, flags);
+
+    fBlock = Block();
+    fBlock.reserve(fBlockSize);
+    fLastEventID = 0;
+
+    return true;
+}
+
+void PhaseSpaceWriter::Close()
+{
+    if (!fFile.is_open()) return;
+
+    if (fBlock.size() > 0) Submit();
+    if (fPending.valid()) fPending.get();
+
+    WriteUInt32(fFile, 0);
+    WriteUInt32(fFile, fBlock.nbOfHistories);
+    fFile.close();
+}
+
+void PhaseSpaceWriter::EndOfEvent()
+{
+    fBlock.nbOfHistories++;
+    if (fBlock.size() >= static_cast<std::size_t>(fBlockSize)) Submit();
+}
+
+void PhaseSpaceWriter::Submit()
+{
+    // Only one block in flight, so that they are written in order
+    if (fPending.valid()) fPending.get();
+
+    fPending = std::async(std::launch::async,
+        [this, block = std::move(fBlock)]() { WriteBlock(block); });
+
+    fBlock = Block();
+    fBlock.reserve(fBlockSize);
+    fLastEventID = 0;
+}
+
+void PhaseSpaceWriter::WriteBlock(const Block& block)
+{
+    auto n = block.size();
+    WriteUInt32(fFile, static_cast<std::uint32_t>(n));
+    WriteUInt32(fFile, block.nbOfHistories);
+
+    WriteColumn(block.pdg.data(), n, sizeof(std::int32_t));
+    WriteColumn(block.ekin.data(), n, sizeof(float));
+    WriteColumn(block.x.data(), n, sizeof(float));
+    WriteColumn(block.y.data(), n, sizeof(float));
+    WriteColumn(block.z.data(), n, sizeof(float));
+    WriteColumn(block.dx.data(), n, sizeof(float));
+    WriteColumn(block.dy.data(), n, sizeof(float));
+    WriteColumn(block.dz.data(), n, sizeof(float));
+    WriteColumn(block.weight.data(), n, sizeof(double));
+    WriteColumn(block.event.data(), n, sizeof(std::int32_t));
+    WriteColumn(block.time.data(), n, sizeof(double));
+}
+
+void PhaseSpaceWriter::WriteColumn(const void* data, std::size_t count, std::size_t typeSize)
+{
+    // Byte shuffle: byte k of every value, then byte k+1...
+    auto bytes = static_cast<const unsigned char*>(data);
+    std::size_t rawSize = count * typeSize;
+    std::vector<unsigned char> shuffled(rawSize);
+    for (std::size_t k = 0; k < typeSize; k++)
+    {
+        for (std::size_t i = 0; i < count; i++) shuffled[k * count + i] = bytes[i * typeSize + k];
+    }
+
+    const unsigned char* stored = shuffled.data();
+    std::size_t storedSize = rawSize;
+
+#ifdef ABSORBER_USE_ZLIB
+    std::vector<unsigned char> compressed;
+    if (fCompressionLevel > 0 && rawSize > 0)
+    {
+        uLongf compressedSize = compressBound(static_cast<uLong>(rawSize));
+        compressed.resize(compressedSize);
+        if (compress2(compressed.data(), &compressedSize, shuffled.data(),
+                static_cast<uLong>(rawSize), fCompressionLevel) == Z_OK
+            && compressedSize < rawSize)
+        {
+            stored = compressed.data();
+            storedSize = compressedSize;
+        }
+    }
+#endif
+
+    WriteUInt32(fFile, static_cast<std::uint32_t>(rawSize));
+    WriteUInt32(fFile, static_cast<std::uint32_t>(storedSize));
+    fFile.write(reinterpret_cast<const char*>(stored), storedSize);
+}
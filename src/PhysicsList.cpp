@@ -0,0 +1,53 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PhysicsList.cpp
+/// \brief Implementation of the PhysicsList class
+
+#include "PhysicsList.h"
+
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4DecayPhysics.hh"
+#include "G4RadioactiveDecayPhysics.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4SystemOfUnits.hh"
+
+PhysicsList::PhysicsList(G4bool fastSimulation)
+{
+    // Same production cut as Shielding
+    SetDefaultCutValue(0.7 * mm);
+
+    RegisterPhysics(new G4EmStandardPhysics_option4);
+    RegisterPhysics(new G4DecayPhysics);
+    RegisterPhysics(new G4RadioactiveDecayPhysics);
+    RegisterPhysics(new G4StepLimiterPhysics);
+    if (!fastSimulation) return;
+
+    auto fastSimulationPhysics = new G4FastSimulationPhysics;
+    fastSimulationPhysics->ActivateFastSimulation("gamma");
+    RegisterPhysics(fastSimulationPhysics);
+}
@@ -0,0 +1,180 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PhysicsTableCache.cpp
+/// \brief Implementation of the PhysicsTableCache class
+
+#include "PhysicsTableCache.h"
+#include "CacheFiles.h"
+
+#include "G4StateManager.hh"
+#include "G4RunManagerKernel.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Material.hh"
+#include "G4Version.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace
+{
+const char* markerName = "cache.key";
+}
+
+PhysicsTableCache::PhysicsTableCache(const G4String& directory, const G4String& physicsListName)
+    : fDirectory(directory), fPhysicsListName(physicsListName)
+{}
+
+G4bool PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+    if (fDirectory.empty()) return true;
+
+    auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+
+    // Initializations from Idle are either a kernel re-initialization or
+    // the one of a run: the key is made again at each of them, so that
+    // the one of the run sees the final geometry
+    if (requestedState == G4State_Init && currentState == G4State_Idle)
+    {
+        Prepare();
+    }
+    else if (requestedState == G4State_GeomClosed && currentState == G4State_Idle && fStorePending)
+    {
+        // The tables are built by the run initialization, just before
+        // the geometry is closed for the run
+        Store();
+    }
+
+    return true;
+}
+
+G4String PhysicsTableCache::MakeKey() const
+{
+    std::ostringstream key;
+    key.precision(10);
+
+    key << G4Version << '\n' << fPhysicsListName << '\n';
+
+    for (auto region : *G4RegionStore::GetInstance())
+    {
+        auto cuts = region->GetProductionCuts();
+        key << "region " << region->GetName();
+        if (cuts)
+        {
+            for (const auto& cut : cuts->GetProductionCuts()) key << ' ' << cut;
+        }
+        key << '\n';
+    }
+
+    for (auto material : *G4Material::GetMaterialTable())
+    {
+        key << "material " << material->GetName()
+            << ' ' << material->GetDensity()
+            << ' ' << material->GetTemperature();
+        auto fractions = material->GetFractionVector();
+        for (std::size_t i = 0; i < material->GetNumberOfElements(); i++)
+        {
+            key << ' ' << material->GetElement(i)->GetZ() << ':' << fractions[i];
+        }
+        key << '\n';
+    }
+
+    return key.str();
+}
+
+void PhysicsTableCache::Prepare()
+{
+    auto physicsList = G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList();
+    if (!physicsList) return;
+
+    auto key = MakeKey();
+    if (key == fKey) return;
+    fKey = key;
+
+    std::ostringstream name;
+    name << fPhysicsListName << '_' << std::hex << std::hash<std::string>()(key);
+    fTablesDirectory = (std::filesystem::path(fDirectory) / name.str()).string();
+
+    // Retrieve only when the stored key matches the whole description
+    std::ifstream marker(std::filesystem::path(fTablesDirectory) / markerName);
+    std::ostringstream stored;
+    stored << marker.rdbuf();
+
+    if (marker && stored.str() == key)
+    {
+        G4cout << " Physics tables retrieved from " << fTablesDirectory << G4endl;
+        physicsList->SetPhysicsTableRetrieved(fTablesDirectory);
+        fStorePending = false;
+    }
+    else
+    {
+        physicsList->ResetPhysicsTableRetrieved();
+        fStorePending = true;
+    }
+}
+
+void PhysicsTableCache::Store()
+{
+    fStorePending = false;
+
+    namespace fs = std::filesystem;
+    std::error_code error;
+
+    // The tables are written to a directory of this process first
+    fs::path tmpDirectory = CacheFiles::GetTmpPath(fTablesDirectory).c_str();
+
+    fs::create_directories(tmpDirectory, error);
+    if (error)
+    {
+        G4cout << "Warning: cannot create the physics table cache "
+            << tmpDirectory.string() << G4endl;
+        return;
+    }
+
+    auto physicsList = G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList();
+    G4bool stored = physicsList->StorePhysicsTable(tmpDirectory.string());
+
+    if (stored)
+    {
+        std::ofstream marker(tmpDirectory / markerName);
+        marker << fKey;
+        stored = static_cast<bool>(marker);
+    }
+
+    // Another job may have stored the same tables in the meantime
+    if (!stored)
+    {
+        fs::remove_all(tmpDirectory, error);
+        return;
+    }
+    if (!CacheFiles::Commit(tmpDirectory.string(), fTablesDirectory)) return;
+
+    G4cout << " Physics tables stored in " << fTablesDirectory << G4endl;
+}
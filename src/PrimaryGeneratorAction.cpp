@@ -28,19 +28,252 @@
 /// \brief Implementation of the PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.h"
+#include "PrimaryGeneratorMessenger.h"
+#include "IsotopeSource.h"
 #include "G4GeneralParticleSource.hh"
+#include "G4SingleParticleSource.hh"
+#include "G4SPSPosDistribution.hh"
+#include "G4SPSAngDistribution.hh"
+
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4ParticleTable.hh"
+#include "G4IonTable.hh"
+#include "G4Ions.hh"
+#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
 {
     fGPS = new G4GeneralParticleSource;
+    fMessenger = new PrimaryGeneratorMessenger(this);
+    fIsotopeSource = new IsotopeSource;
 }
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+    delete fIsotopeSource;
+    delete fMessenger;
     delete fGPS;
 }
 
+void PrimaryGeneratorAction::SetNbOfTabulatedDecays(G4int nb)
+{
+    fNbOfTabulatedDecays = nb;
+    fIsotopeSource->SetNbOfTabulatedDecays(nb);
+}
+
+void PrimaryGeneratorAction::SetBeamParticle(const G4String& name)
+{
+    auto particle = G4ParticleTable::GetParticleTable()->FindParticle(name);
+    if (!particle)
+    {
+        G4cout << "Warning: beam particle " << name << " is unknown." << G4endl;
+        return;
+    }
+    fBeamParticle = particle;
+}
+
+void PrimaryGeneratorAction::SetBeamEnergyRange(G4double minEnergy, G4double maxEnergy)
+{
+    if (minEnergy > maxEnergy)
+    {
+        G4cout << "Warning: Wrong beam energy range!" << G4endl;
+        return;
+    }
+    fBeamMinEnergy = minEnergy;
+    fBeamMaxEnergy = maxEnergy;
+}
+
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
+    fIsotropicPrimaries = (fSourceMode == kEmissionTable) || (fSourceMode == kIsotopeSource)
+        || (fSourceMode == kGeneralParticleSource
+            && fGPS->GetCurrentSource()->GetAngDist()->GetDistType() == "iso");
+
+    if (fSourceMode == kPhaseSpace)
+    {
+        ReplayEvent(anEvent);
+        return;
+    }
+
+    if (fSourceMode == kIsotopeSource)
+    {
+        fIsotopeSource->GeneratePrimaryVertex(anEvent);
+        return;
+    }
+
+    if (fSourceMode == kEmissionTable)
+    {
+        EmitDecay(anEvent);
+        return;
+    }
+
+    if (fSourceMode == kBeam)
+    {
+        GenerateBeam(anEvent);
+        return;
+    }
+
     fGPS->GeneratePrimaryVertex(anEvent);
 }
+
+void PrimaryGeneratorAction::ReplayEvent(G4Event* anEvent)
+{
+    auto reader = PhaseSpaceReader::Instance();
+    auto runManager = G4RunManager::GetRunManager();
+    auto runID = runManager->GetCurrentRun()->GetRunID();
+
+    if (runID != fRunID)
+    {
+        fRunID = runID;
+        fRecords.clear();
+        fNextRecord = 0;
+        fRepeat = 0;
+        if (!reader->Open(fFileNames))
+        {
+            G4cout << "Warning: no phase space to replay." << G4endl;
+        }
+    }
+
+    // Next block once the current one is replayed; the run of this
+    // thread ends when all blocks were taken
+    while (fNextRecord >= fRecords.size())
+    {
+        fNextRecord = 0;
+        if (!reader->NextBlock(runID, fRecords))
+        {
+            fRecords.clear();
+            runManager->AbortRun(true);
+            return;
+        }
+    }
+
+    // Records of one recorded event
+    auto first = fNextRecord;
+    auto last = first;
+    while (last < fRecords.size() && fRecords[last].eventID == fRecords[first].eventID) last++;
+
+    G4double phi = fRotation ? twopi * G4UniformRand() : 0.0;
+
+    for (auto i = first; i < last; i++)
+    {
+        const auto& record = fRecords[i];
+        auto particle = GetParticle(record.pdg);
+        if (!particle) continue;
+
+        auto position = record.position;
+        auto direction = record.direction;
+        if (phi != 0.0)
+        {
+            position.rotateZ(phi);
+            direction.rotateZ(phi);
+        }
+
+        auto primary = new G4PrimaryParticle(particle);
+        primary->SetKineticEnergy(record.ekin);
+        primary->SetMomentumDirection(direction);
+        primary->SetWeight(record.weight / fRecycling);
+
+        auto vertex = new G4PrimaryVertex(position, record.time);
+        vertex->SetPrimary(primary);
+        anEvent->AddPrimaryVertex(vertex);
+    }
+
+    if (++fRepeat >= fRecycling)
+    {
+        fRepeat = 0;
+        fNextRecord = last;
+    }
+}
+
+void PrimaryGeneratorAction::PrepareRun()
+{
+    // The tables follow the source, they are looked up again at each
+    // run; the master tabulates them, the workers find them in memory
+    fEmissionTable.reset();
+    if (fSourceMode == kIsotopeSource) fIsotopeSource->Prepare();
+
+    // The line intensities and spectra of the tables carry the statistical
+    // error of their decays, which a longer run cannot reduce
+    G4bool tables = (fSourceMode == kEmissionTable)
+        || (fSourceMode == kIsotopeSource && fIsotopeSource->GetEmissionTables());
+    auto run = G4RunManager::GetRunManager()->GetCurrentRun();
+    if (tables && run && G4Threading::IsMasterThread()
+        && run->GetNumberOfEventToBeProcessed() > fNbOfTabulatedDecays)
+    {
+        G4cout << "Warning: the run has more events than the " << fNbOfTabulatedDecays
+            << " decays of its emission tables, whose statistical error it keeps"
+            << " (see /src/tabulatedDecays)." << G4endl;
+    }
+
+    if (fSourceMode != kEmissionTable) return;
+
+    auto ion = dynamic_cast<G4Ions*>(fGPS->GetParticleDefinition());
+    if (ion && ion->IsGeneralIon())
+    {
+        fEmissionTable = EmissionTable::Get(ion->GetAtomicNumber(), ion->GetAtomicMass(),
+            ion->GetExcitationEnergy(), fNbOfTabulatedDecays);
+    }
+    if (!fEmissionTable && G4Threading::IsMasterThread())
+    {
+        G4cout << "Warning: no emission table for the source, "
+            << "its particle is tracked instead." << G4endl;
+    }
+}
+
+void PrimaryGeneratorAction::EmitDecay(G4Event* anEvent)
+{
+    if (!fEmissionTable)
+    {
+        fGPS->GeneratePrimaryVertex(anEvent);
+        return;
+    }
+
+    fEmissionTable->Sample(fDecay);
+    if (fDecay.empty()) return;
+
+    auto position = fGPS->GetCurrentSource()->GetPosDist()->GenerateOne();
+    auto vertex = new G4PrimaryVertex(position, 0.0);
+    for (const auto& emission : fDecay)
+    {
+        auto primary = new G4PrimaryParticle(emission.particle);
+        primary->SetKineticEnergy(emission.ekin);
+        primary->SetMomentumDirection(G4RandomDirection());
+        vertex->SetPrimary(primary);
+    }
+    anEvent->AddPrimaryVertex(vertex);
+}
+
+void PrimaryGeneratorAction::GenerateBeam(G4Event* anEvent)
+{
+    if (!fBeamParticle) return;
+
+    auto primary = new G4PrimaryParticle(fBeamParticle);
+    primary->SetKineticEnergy(fBeamMinEnergy + (fBeamMaxEnergy - fBeamMinEnergy) * G4UniformRand());
+    primary->SetMomentumDirection(G4ThreeVector(0, 0, 1));
+
+    auto vertex = new G4PrimaryVertex(G4ThreeVector(0, 0, fBeamZ), 0.0);
+    vertex->SetPrimary(primary);
+    anEvent->AddPrimaryVertex(vertex);
+}
+
+G4ParticleDefinition* PrimaryGeneratorAction::GetParticle(G4int pdg)
+{
+    auto it = fParticles.find(pdg);
+    if (it != fParticles.end()) return it->second;
+
+    auto particle = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+    if (!particle && pdg > 1000000000) particle = G4IonTable::GetIonTable()->GetIon(pdg);
+    if (!particle)
+    {
+        G4cout << "Warning: particle " << pdg << " of the phase space is unknown." << G4endl;
+    }
+
+    fParticles[pdg] = particle;
+    return particle;
+}
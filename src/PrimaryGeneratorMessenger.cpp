@@ -0,0 +1,201 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/PrimaryGeneratorMessenger.cpp
+/// \brief Implementation of the PrimaryGeneratorMessenger class
+
+#include "PrimaryGeneratorMessenger.h"
+#include "PrimaryGeneratorAction.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
+
+PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(PrimaryGeneratorAction* action)
+    : fAction(action)
+{
+    fDirectory = new G4UIdirectory("/src/");
+    fDirectory->SetGuidance("Source of the primary particles.");
+
+    fModeCmd = new G4UIcmdWithAString("/src/mode", this);
+    fModeCmd->SetGuidance("Select the source of the primaries:");
+    fModeCmd->SetGuidance("  gps  : general particle source (/gps/ commands),");
+    fModeCmd->SetGuidance("  phsp : replay of phase space files (/src/addFile),");
+    fModeCmd->SetGuidance("         the run ends when all the records were replayed;");
+    fModeCmd->SetGuidance("         the recorded weights already include any emission biasing,");
+    fModeCmd->SetGuidance("  emission : isotropic emissions of one decay of the ion of the");
+    fModeCmd->SetGuidance("         general particle source, from its emission table,");
+    fModeCmd->SetGuidance("         at a position of the source; the ion is not tracked,");
+    fModeCmd->SetGuidance("  iso  : isotope source (/src/iso/ commands),");
+    fModeCmd->SetGuidance("  beam : pencil beam along z (/src/beam/ commands).");
+    fModeCmd->SetParameterName("mode", false);
+    fModeCmd->SetCandidates("gps phsp emission iso beam");
+    fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAddFileCmd = new G4UIcmdWithAString("/src/addFile", this);
+    fAddFileCmd->SetGuidance("Add a phase space file to replay.");
+    fAddFileCmd->SetParameterName("fileName", false);
+    fAddFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fClearFilesCmd = new G4UIcmdWithoutParameter("/src/clearFiles", this);
+    fClearFilesCmd->SetGuidance("Remove all phase space files.");
+    fClearFilesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecycleCmd = new G4UIcmdWithAnInteger("/src/recycle", this);
+    fRecycleCmd->SetGuidance("Replay each recorded event nb times, with weights divided by nb.");
+    fRecycleCmd->SetParameterName("nb", false);
+    fRecycleCmd->SetRange("nb>0");
+    fRecycleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRotateCmd = new G4UIcmdWithABool("/src/rotate", this);
+    fRotateCmd->SetGuidance("Rotate each replayed event by a random angle around the z axis.");
+    fRotateCmd->SetParameterName("rotate", false);
+    fRotateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fTabulatedDecaysCmd = new G4UIcmdWithAnInteger("/src/tabulatedDecays", this);
+    fTabulatedDecaysCmd->SetGuidance("Number of decays sampled to tabulate the emissions of a nuclide.");
+    fTabulatedDecaysCmd->SetGuidance("Their line intensities and spectra keep its statistical error.");
+    fTabulatedDecaysCmd->SetGuidance("Tables are cached in the table cache directory (-c), if any.");
+    fTabulatedDecaysCmd->SetParameterName("nb", false);
+    fTabulatedDecaysCmd->SetRange("nb>0");
+    fTabulatedDecaysCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBeamDirectory = new G4UIdirectory("/src/beam/");
+    fBeamDirectory->SetGuidance("Pencil beam along the z axis, on axis.");
+
+    fBeamParticleCmd = new G4UIcmdWithAString("/src/beam/particle", this);
+    fBeamParticleCmd->SetGuidance("Set the particle of the beam.");
+    fBeamParticleCmd->SetParameterName("name", false);
+    fBeamParticleCmd->AvailableForStates(G4State_Idle);
+
+    fBeamEnergyCmd = new G4UIcommand("/src/beam/energy", this);
+    fBeamEnergyCmd->SetGuidance("Set the energy range of the beam, sampled uniformly.");
+    auto minPrm = new G4UIparameter("min", 'd', false);
+    minPrm->SetParameterRange("min>=0.");
+    fBeamEnergyCmd->SetParameter(minPrm);
+    auto maxPrm = new G4UIparameter("max", 'd', false);
+    maxPrm->SetParameterRange("max>=0.");
+    fBeamEnergyCmd->SetParameter(maxPrm);
+    auto unitPrm = new G4UIparameter("unit", 's', true);
+    unitPrm->SetDefaultUnit("keV");
+    fBeamEnergyCmd->SetParameter(unitPrm);
+    fBeamEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBeamZCmd = new G4UIcmdWithADoubleAndUnit("/src/beam/z", this);
+    fBeamZCmd->SetGuidance("Set the z position of the beam origin.");
+    fBeamZCmd->SetParameterName("z", false);
+    fBeamZCmd->SetUnitCategory("Length");
+    fBeamZCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+PrimaryGeneratorMessenger::~PrimaryGeneratorMessenger()
+{
+    delete fModeCmd;
+    delete fAddFileCmd;
+    delete fClearFilesCmd;
+    delete fRecycleCmd;
+    delete fRotateCmd;
+    delete fTabulatedDecaysCmd;
+    delete fBeamParticleCmd;
+    delete fBeamEnergyCmd;
+    delete fBeamZCmd;
+    delete fBeamDirectory;
+    delete fDirectory;
+}
+
+void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fModeCmd)
+    {
+        auto mode = PrimaryGeneratorAction::kGeneralParticleSource;
+        if (newValue == "phsp") mode = PrimaryGeneratorAction::kPhaseSpace;
+        if (newValue == "emission") mode = PrimaryGeneratorAction::kEmissionTable;
+        if (newValue == "iso") mode = PrimaryGeneratorAction::kIsotopeSource;
+        if (newValue == "beam") mode = PrimaryGeneratorAction::kBeam;
+        fAction->SetSourceMode(mode);
+    }
+
+    if (command == fAddFileCmd)
+    {
+        fAction->AddPhaseSpaceFile(newValue);
+    }
+
+    if (command == fClearFilesCmd)
+    {
+        fAction->ClearPhaseSpaceFiles();
+    }
+
+    if (command == fRecycleCmd)
+    {
+        fAction->SetRecycling(fRecycleCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fRotateCmd)
+    {
+        fAction->SetRotation(fRotateCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fTabulatedDecaysCmd)
+    {
+        fAction->SetNbOfTabulatedDecays(fTabulatedDecaysCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fBeamParticleCmd)
+    {
+        fAction->SetBeamParticle(newValue);
+    }
+
+    if (command == fBeamEnergyCmd)
+    {
+        G4double minEnergy = 0.0, maxEnergy = 0.0;
+        G4String unit;
+        std::istringstream is(newValue);
+        is >> minEnergy >> maxEnergy >> unit;
+        auto value = G4UIcommand::ValueOf(unit);
+        fAction->SetBeamEnergyRange(minEnergy * value, maxEnergy * value);
+    }
+
+    if (command == fBeamZCmd)
+    {
+        fAction->SetBeamZ(fBeamZCmd->GetNewDoubleValue(newValue));
+    }
+}
+
+G4String PrimaryGeneratorMessenger::GetCurrentValue(G4UIcommand* command)
+{
+    if (command == fModeCmd)
+    {
+        const char* modeName[] = { "gps", "phsp", "emission", "iso", "beam" };
+        return modeName[fAction->GetSourceMode()];
+    }
+    return "";
+}
@@ -0,0 +1,154 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/Profiler.cpp
+/// \brief Implementation of the Profiler class
+
+#include "Profiler.h"
+#include "ProfilerMessenger.h"
+
+#include "G4AutoLock.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4VProcess.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+namespace
+{
+G4Mutex mergeMutex = G4MUTEX_INITIALIZER;
+
+// Counters of all the threads, by name
+std::map<G4String, Profiler::Counters> merged[Profiler::kNbOfCategories];
+
+const char* categoryName[] = { "volume", "particle", "process" };
+
+G4String GetName(G4int category, const void* key)
+{
+    if (category == Profiler::kVolume)
+    {
+        return key ? static_cast<const G4VPhysicalVolume*>(key)->GetName() : G4String("none");
+    }
+    if (category == Profiler::kParticle)
+    {
+        return static_cast<const G4ParticleDefinition*>(key)->GetParticleName();
+    }
+    // Tracks without creator process are the primaries
+    return key ? static_cast<const G4VProcess*>(key)->GetProcessName() : G4String("primary");
+}
+}
+
+Profiler::Profiler()
+{
+    fMessenger = new ProfilerMessenger(this);
+}
+
+Profiler::~Profiler()
+{
+    delete fMessenger;
+}
+
+void Profiler::BeginOfRun()
+{
+    for (auto& counters : fCounters) counters.clear();
+    fLastTime = Clock::now();
+}
+
+void Profiler::Merge()
+{
+    G4AutoLock lock(&mergeMutex);
+    for (G4int i = 0; i < kNbOfCategories; i++)
+    {
+        for (const auto& [key, counters] : fCounters[i])
+        {
+            auto& total = merged[i][GetName(i, key)];
+            total.steps += counters.steps;
+            total.tracks += counters.tracks;
+            total.time += counters.time;
+        }
+        fCounters[i].clear();
+    }
+}
+
+void Profiler::Report(const G4String& fileName)
+{
+    G4AutoLock lock(&mergeMutex);
+    if (merged[kVolume].empty()) return;
+
+    std::ofstream file(fileName);
+    if (file) file << "category,name,steps,tracks,time[s]\n";
+
+    for (G4int i = 0; i < kNbOfCategories; i++)
+    {
+        // Most expensive first
+        std::vector<std::pair<G4String, Counters>> rows(merged[i].begin(), merged[i].end());
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b)
+            { return a.second.time > b.second.time; });
+
+        G4double totalTime = 0.0;
+        for (const auto& row : rows) totalTime += row.second.time;
+
+        G4cout
+            << G4endl
+            << " Profile per " << categoryName[i] << " (" << totalTime << " s in steps)"
+            << G4endl
+            << std::setw(24) << "name" << std::setw(14) << "steps" << std::setw(12) << "tracks"
+            << std::setw(12) << "time [s]" << std::setw(8) << "%" << std::setw(12) << "us/step"
+            << G4endl;
+
+        G4int nbOfRows = 0;
+        for (const auto& [name, counters] : rows)
+        {
+            if (file)
+            {
+                file << categoryName[i] << ',' << name << ',' << counters.steps << ','
+                    << counters.tracks << ',' << counters.time << '\n';
+            }
+
+            if (fNbOfRows > 0 && nbOfRows++ >= fNbOfRows) continue;
+            G4cout
+                << std::setw(24) << name << std::setw(14) << counters.steps
+                << std::setw(12) << counters.tracks << std::setw(12) << counters.time
+                << std::setw(8) << std::setprecision(3)
+                << (totalTime > 0.0 ? 100.0 * counters.time / totalTime : 0.0)
+                << std::setw(12)
+                << (counters.steps > 0 ? 1.0e6 * counters.time / counters.steps : 0.0)
+                << std::setprecision(6) << G4endl;
+        }
+
+        merged[i].clear();
+    }
+
+    if (!file)
+    {
+        G4cout << "Warning: the profile could not be written to " << fileName << G4endl;
+    }
+}
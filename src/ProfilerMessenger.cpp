@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ProfilerMessenger.cpp
+/// \brief Implementation of the ProfilerMessenger class
+
+#include "ProfilerMessenger.h"
+#include "Profiler.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+ProfilerMessenger::ProfilerMessenger(Profiler* profiler)
+    : fProfiler(profiler)
+{
+    fDirectory = new G4UIdirectory("/prof/");
+    fDirectory->SetGuidance("Step and time profile per volume, particle and process.");
+
+    fEnableCmd = new G4UIcmdWithABool("/prof/enable", this);
+    fEnableCmd->SetGuidance("Profile the steps of the next runs; the profile is printed at");
+    fEnableCmd->SetGuidance("end of run and written to <analysis file>_profile.csv.");
+    fEnableCmd->SetGuidance("Timing every step slows the simulation down a little.");
+    fEnableCmd->SetParameterName("enable", false);
+    fEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRowsCmd = new G4UIcmdWithAnInteger("/prof/rows", this);
+    fRowsCmd->SetGuidance("Set the number of printed rows per table (0: all).");
+    fRowsCmd->SetParameterName("nb", false);
+    fRowsCmd->SetRange("nb>=0");
+    fRowsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+ProfilerMessenger::~ProfilerMessenger()
+{
+    delete fEnableCmd;
+    delete fRowsCmd;
+    delete fDirectory;
+}
+
+void ProfilerMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fEnableCmd)
+    {
+        fProfiler->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fRowsCmd)
+    {
+        fProfiler->SetNbOfRows(fRowsCmd->GetNewIntValue(newValue));
+    }
+}
@@ -0,0 +1,439 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ResponseManager.cpp
+/// \brief Implementation of the ResponseManager class
+
+#include "ResponseManager.h"
+#include "ResponseMessenger.h"
+#include "DetectorConstruction.h"
+#include "StackingAction.h"
+#include "RunSummary.h"
+
+#include "G4AnalysisManager.hh"
+#include "G4NistManager.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4Timer.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+
+ResponseManager::ResponseManager(DetectorConstruction* det, const G4String& physicsListName,
+    const G4String& cacheDirectory)
+    : fDetConstruction(det), fPhysicsListName(physicsListName), fCacheDirectory(cacheDirectory)
+{
+    fMaxEnergy = 1500 * keV;
+    fMessenger = new ResponseMessenger(this);
+}
+
+ResponseManager::~ResponseManager()
+{
+    delete fMessenger;
+}
+
+void ResponseManager::SetEnergyBins(G4int nbOfBins, G4double maxEnergy)
+{
+    // The responses in memory are binned differently
+    fNbOfBins = nbOfBins;
+    fMaxEnergy = maxEnergy;
+    fResponses.clear();
+    fDetectorResponse.reset();
+}
+
+const ResponseMatrix* ResponseManager::GetResponse(const G4String& material, G4double thickness)
+{
+    std::pair<G4String, G4long> key{ material, std::lround(thickness / nm) };
+    auto it = fResponses.find(key);
+    if (it != fResponses.end()) return it->second.get();
+
+    if (thickness <= 0.0 || !G4NistManager::Instance()->FindOrBuildMaterial(material))
+    {
+        G4cout << "Warning: no response for " << thickness / mm << " mm of "
+            << material << "!" << G4endl;
+        return nullptr;
+    }
+
+    auto& entry = fResponses[key];
+    entry = MakeResponse(material, thickness);
+    return entry.get();
+}
+
+void ResponseManager::PrepareFastSimulation()
+{
+    // The slabs are listed first, as the response runs change the stack
+    auto slabs = fDetConstruction->GetFastSimulationSlabs();
+    if (slabs.empty())
+    {
+        G4cout << "Warning: no absorber simulated fast (/det/setFastSim)!" << G4endl;
+        return;
+    }
+
+    for (const auto& [mat, thick] : slabs)
+    {
+        auto response = GetResponse(mat, thick);
+        if (response) SlabTransmission::Publish(mat, thick, response->GetTransmission());
+    }
+}
+
+const ResponseMatrix* ResponseManager::GetDetectorResponse()
+{
+    if (!fDetectorResponse) fDetectorResponse = MakeResponse("", 0.0);
+    return fDetectorResponse.get();
+}
+
+std::unique_ptr<ResponseMatrix> ResponseManager::MakeResponse(const G4String& material, G4double thickness)
+{
+    // The response of the detector is named after it, with its length
+    G4String name = material;
+    if (material.empty())
+    {
+        name = "detector";
+        thickness = fDetConstruction->GetDetectorBackZ() - fDetConstruction->GetDetectorFrontZ();
+    }
+
+    auto settings = GetSettings(material, thickness);
+    auto response = std::make_unique<ResponseMatrix>(name, thickness,
+        fNbOfBins, fMaxEnergy, fEventsPerBin, settings);
+    auto fileName = GetCacheFileName(name, thickness, settings);
+    if (fileName.empty() || !response->Load(fileName))
+    {
+        Compute(*response, material, thickness);
+        if (!fileName.empty()) response->Save(fileName);
+    }
+    return response;
+}
+
+void ResponseManager::Compute(ResponseMatrix& response, const G4String& material, G4double thickness)
+{
+    G4bool detector = material.empty();
+    if (detector)
+    {
+        G4cout << G4endl << "Computing the response of the detector" << G4endl;
+    }
+    else
+    {
+        G4cout << G4endl << "Computing the response of " << thickness / mm << " mm of "
+            << material << G4endl;
+    }
+
+    auto UImanager = G4UImanager::GetUIpointer();
+    auto command = [UImanager](const auto&... args)
+    {
+        std::ostringstream os;
+        (os << ... << args);
+        UImanager->ApplyCommand(os.str());
+    };
+
+    // User settings changed by the response runs, restored afterwards;
+    // the per thread ones through the commands of the master
+    auto analysisManager = G4AnalysisManager::Instance();
+    auto stack = fDetConstruction->GetStack();
+    auto fastSimulation = fDetConstruction->GetFastSimulation();
+    auto culling = fDetConstruction->GetAcceptanceCulling();
+    std::vector<G4String> restoreCommands{
+        "/src/mode " + UImanager->GetCurrentValues("/src/mode"),
+        "/phsp/write " + UImanager->GetCurrentValues("/phsp/write"),
+        "/analysis/setFileName " + analysisManager->GetFileName() };
+
+    for (G4int ih = 1; ih < RunAction::kMaxHisto; ih++)
+    {
+        auto h1 = analysisManager->GetH1(ih);
+        if (!h1) continue;
+
+        // The axis edges are in the unit of the spectrum, after its function
+        G4String fcn = analysisManager->GetH1XFcnName(ih);
+        auto inverse = [&fcn](G4double x)
+        {
+            if (fcn == "log10") return std::pow(10.0, x);
+            if (fcn == "log") return std::exp(x);
+            if (fcn == "exp") return std::log(x);
+            return x;
+        };
+
+        const auto& axis = h1->axis();
+        G4int nbins = axis.bins();
+        G4String binScheme = "linear";
+        if (!axis.is_fixed_binning())
+        {
+            // Otherwise logarithmic, with a constant ratio of the edges
+            binScheme = "log";
+            auto ratio = inverse(axis.bin_upper_edge(0)) / inverse(axis.bin_lower_edge(0));
+            for (G4int ibin = 1; ibin < nbins; ibin++)
+            {
+                auto binRatio = inverse(axis.bin_upper_edge(ibin)) / inverse(axis.bin_lower_edge(ibin));
+                if (!(std::abs(binRatio - ratio) <= 1e-6 * ratio)) binScheme.clear();
+            }
+        }
+
+        std::ostringstream set;
+        set.precision(std::numeric_limits<G4double>::max_digits10);
+        set << "/analysis/h1/set " << ih << ' ' << nbins << ' '
+            << inverse(axis.lower_edge()) << ' ' << inverse(axis.upper_edge()) << ' '
+            << analysisManager->GetH1XUnitName(ih) << ' ' << fcn << ' ' << binScheme;
+        if (binScheme.empty())
+        {
+            G4cout << "Warning: the binning of spectrum " << ih
+                << " cannot be restored after the response runs!" << G4endl;
+        }
+        else
+        {
+            restoreCommands.push_back(set.str());
+        }
+        restoreCommands.push_back("/analysis/h1/setActivation " + std::to_string(ih)
+            + (analysisManager->GetH1Activation(ih) ? " true" : " false"));
+    }
+
+    // Unbiased runs of the single layer, scored at its exit face,
+    // or of the detector without absorber, scored as usual
+    fDetConstruction->SetStack({});
+    if (!detector) fDetConstruction->AddAbsorber(material, thickness);
+    fDetConstruction->SetFastSimulation(false);
+    fDetConstruction->SetAcceptanceCulling(false);
+    fDetConstruction->SetExitPlaneScoring(!detector);
+    StackingAction::SetSuspended(true);
+    command("/run/reinitializeGeometry");
+    command("/phsp/write false");
+
+    // Pencil beam just in front of the layer or of the detector (the
+    // stack starts where the detector would without absorber)
+    command("/src/mode beam");
+    command("/src/beam/z ", (fDetConstruction->GetStackFrontZ() - 1 * um) / mm, " mm");
+
+    // Spectra binned as the response
+    for (G4int ih = 1; ih < RunAction::kMaxHisto; ih++)
+    {
+        command("/analysis/h1/set ", ih, ' ', fNbOfBins, " 0 ", fMaxEnergy / keV, " keV");
+    }
+    command("/analysis/setFileName response");
+
+    auto binWidth = fMaxEnergy / fNbOfBins;
+
+    for (G4int input = 0; input < ResponseMatrix::kNbOfInputs; input++)
+    {
+        auto particleName = ResponseMatrix::kInputParticles[input];
+        command("/src/beam/particle ", particleName);
+
+        // The photons leaving a layer also fill its transmission tables
+        G4bool transmission = !detector && G4String(particleName) == "gamma";
+        if (transmission) SlabTransmission::Tally::SetBins(fNbOfBins, fMaxEnergy);
+
+        for (G4int bin = 0; bin < fNbOfBins; bin++)
+        {
+            command("/src/beam/energy ", bin * binWidth / keV, ' ', (bin + 1) * binWidth / keV, " keV");
+            command("/run/beamOn ", fEventsPerBin);
+            if (transmission) response.SetTransmission(bin, SlabTransmission::Tally::TakeMerged());
+
+            // The file name is decorated by the run action
+            auto summaryFileName = G4AnalysisManager::Instance()->GetFileName() + ".summary";
+            auto spectra = response.MakeSpectra();
+            if (!ReadSummary(summaryFileName, spectra))
+            {
+                G4cout << "Warning: no spectra for " << particleName
+                    << " in bin " << bin << "!" << G4endl;
+                continue;
+            }
+            response.SetResponse(input, bin, spectra);
+        }
+        SlabTransmission::Tally::SetBins(0, 0.0);
+    }
+
+    fDetConstruction->SetStack(stack);
+    fDetConstruction->SetFastSimulation(fastSimulation);
+    fDetConstruction->SetAcceptanceCulling(culling);
+    fDetConstruction->SetExitPlaneScoring(false);
+    StackingAction::SetSuspended(false);
+    for (const auto& restoreCommand : restoreCommands) UImanager->ApplyCommand(restoreCommand);
+    command("/run/reinitializeGeometry");
+}
+
+G4bool ResponseManager::ReadSummary(const G4String& fileName, ResponseMatrix::Spectra& spectra) const
+{
+    RunSummary summary;
+    if (!summary.Read(fileName))
+    {
+        G4cout << "Warning: run summary " << fileName << " cannot be opened!" << G4endl;
+        return false;
+    }
+
+    // Weighted sums of the bins of the spectra, per event; the
+    // spectra must be binned as the responses, in keV
+    for (const auto& [ih, spectrum] : summary.spectra)
+    {
+        G4double edge = spectrum.edges.empty() ? 0.0 : spectrum.edges.back();
+        if (spectrum.nbins != fNbOfBins || std::abs(edge - fMaxEnergy / keV) > 1e-6 * edge)
+        {
+            G4cout << "Warning: spectrum " << ih << " of " << fileName
+                << " is not binned as the responses!" << G4endl;
+            return false;
+        }
+        if (ih <= 0 || ih >= RunAction::kMaxHisto) continue;
+        for (G4int ibin = 1; ibin <= fNbOfBins; ibin++) spectra[ih][ibin - 1] = spectrum.bins[ibin][1];
+    }
+
+    if (summary.nofEvents <= 0) return false;
+
+    auto nbOfEvents = static_cast<G4double>(summary.nofEvents);
+    for (auto& spectrum : spectra)
+    {
+        for (auto& value : spectrum) value /= nbOfEvents;
+    }
+    return true;
+}
+
+void ResponseManager::Evaluate(const G4String& stackFileName, const G4String& sourceFileName,
+    const G4String& outputFileName)
+{
+    ResponseMatrix::Spectra source;
+    for (auto& spectrum : source) spectrum.assign(fNbOfBins, 0.0);
+    if (!ReadSummary(sourceFileName, source)) return;
+
+    std::ifstream stackFile(stackFileName);
+    if (!stackFile)
+    {
+        G4cout << "Warning: Stack file " << stackFileName
+            << " cannot be opened!" << G4endl;
+        return;
+    }
+
+    // One candidate per line: name, then material thickness unit
+    // for each layer from the source; # starts a comment
+    std::vector<std::pair<G4String, std::vector<std::pair<G4String, G4double>>>> candidates;
+    G4String line;
+    while (std::getline(stackFile, line))
+    {
+        std::istringstream is(line);
+        G4String name, mat, unit;
+        G4double thick = 0.0;
+        if (!(is >> name) || name[0] == '#') continue;
+
+        std::vector<std::pair<G4String, G4double>> layers;
+        while (is >> mat >> thick >> unit)
+        {
+            layers.emplace_back(mat, thick * G4UIcommand::ValueOf(unit));
+        }
+        candidates.emplace_back(name, layers);
+    }
+
+    // The missing responses are computed first, the folding is then timed
+    for (const auto& candidate : candidates)
+    {
+        for (const auto& layer : candidate.second) GetResponse(layer.first, layer.second);
+    }
+    auto detector = GetDetectorResponse();
+
+    std::ofstream output(outputFileName);
+    if (!output)
+    {
+        G4cout << "Warning: Cannot write " << outputFileName << "!" << G4endl;
+        return;
+    }
+
+    // One row per candidate and transmitted spectrum, per source event
+    output << "candidate,slot,total";
+    for (G4int bin = 0; bin < fNbOfBins; bin++)
+    {
+        output << ",bin" << bin;
+    }
+    output << '\n';
+
+    G4Timer timer;
+    timer.Start();
+    G4int nbOfCandidates = 0;
+
+    for (const auto& [name, layers] : candidates)
+    {
+        auto spectra = source;
+        G4bool complete = true;
+        for (const auto& [mat, thick] : layers)
+        {
+            auto response = GetResponse(mat, thick);
+            if (!response)
+            {
+                complete = false;
+                break;
+            }
+            spectra = response->Fold(spectra, fPositronFraction);
+        }
+        if (!complete) continue;
+
+        // The particles leaving the stack enter the detector
+        spectra = detector->Fold(spectra, fPositronFraction);
+
+        for (G4int ih = 1; ih < RunAction::kMaxHisto; ih++)
+        {
+            G4double total = 0.0;
+            for (auto value : spectra[ih]) total += value;
+            if (total == 0.0) continue;
+
+            output << name << ',' << ih << ',' << total;
+            for (auto value : spectra[ih]) output << ',' << value;
+            output << '\n';
+        }
+        nbOfCandidates++;
+    }
+
+    timer.Stop();
+    G4cout << nbOfCandidates << " stack candidate(s) folded in " << timer.GetRealElapsed()
+        << " s, written to " << outputFileName << G4endl;
+}
+
+G4String ResponseManager::GetSettings(const G4String& material, G4double thickness) const
+{
+    // Physics list, default cuts and charged cut of the layer (or detector),
+    // user limits of the absorbers, radius, stack front and detector length
+    auto defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+    auto cut = material.empty() ? fDetConstruction->GetDetectorCut()
+        : fDetConstruction->GetAbsorberCut(thickness);
+
+    std::ostringstream settings;
+    settings << fPhysicsListName << " charged cuts";
+    for (auto defaultCut : defaultCuts->GetProductionCuts()) settings << ' ' << defaultCut / mm;
+    settings << ' ' << cut / mm
+        << " limits " << fDetConstruction->GetMaxStep() / mm
+        << ' ' << fDetConstruction->GetMinKinEnergy() / keV
+        << " geometry " << fDetConstruction->GetRadius() / mm
+        << ' ' << fDetConstruction->GetStackFrontZ() / mm
+        << ' ' << (fDetConstruction->GetDetectorBackZ() - fDetConstruction->GetDetectorFrontZ()) / mm;
+    return settings.str();
+}
+
+G4String ResponseManager::GetCacheFileName(const G4String& name, G4double thickness,
+    const G4String& settings) const
+{
+    if (fCacheDirectory.empty()) return "";
+
+    std::ostringstream fileName;
+    fileName << fCacheDirectory << "/response_" << name << '_' << std::lround(thickness / nm)
+        << "nm_" << fNbOfBins << 'x' << fMaxEnergy / keV << "keV_N" << fEventsPerBin
+        << '_' << std::hex << std::hash<std::string>()(settings) << ".txt";
+    return fileName.str();
+}
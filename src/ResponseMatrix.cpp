@@ -0,0 +1,166 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ResponseMatrix.cpp
+/// \brief Implementation of the ResponseMatrix class
+
+#include "ResponseMatrix.h"
+#include "CacheFiles.h"
+
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+ResponseMatrix::ResponseMatrix(const G4String& material, G4double thickness,
+    G4int nbOfBins, G4double maxEnergy, G4int nbOfEvents, const G4String& settings)
+    : fMaterial(material), fThickness(thickness),
+    fNbOfBins(nbOfBins), fMaxEnergy(maxEnergy), fNbOfEvents(nbOfEvents), fSettings(settings),
+    fTransmission(std::make_shared<SlabTransmission>(nbOfBins, maxEnergy))
+{
+    for (auto& response : fResponse)
+    {
+        response.assign(static_cast<std::size_t>(nbOfBins) * RunAction::kMaxHisto * nbOfBins, 0.0);
+    }
+}
+
+G4String ResponseMatrix::GetHeader() const
+{
+    std::ostringstream header;
+    header << "absorber response matrix 2\n" << G4Version << '\n';
+    header << fMaterial << ' ' << fThickness / nm << '\n';
+    header << fNbOfBins << ' ' << fMaxEnergy / keV << ' ' << fNbOfEvents << '\n';
+    header << fSettings << '\n';
+    return header.str();
+}
+
+G4bool ResponseMatrix::Load(const G4String& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file) return false;
+
+    // The header must match line by line
+    std::istringstream header(GetHeader());
+    std::string expected, line;
+    while (std::getline(header, expected))
+    {
+        if (!std::getline(file, line) || line != expected) return false;
+    }
+
+    for (auto& response : fResponse)
+    {
+        for (auto& value : response)
+        {
+            if (!(file >> value)) return false;
+        }
+    }
+    if (!fTransmission->Read(file)) return false;
+
+    G4cout << "Response of " << fThickness / mm << " mm of " << fMaterial
+        << " read from " << fileName << G4endl;
+    return true;
+}
+
+void ResponseMatrix::Save(const G4String& fileName) const
+{
+    auto write = [this](std::ostream& file)
+    {
+        file << GetHeader();
+        file.precision(std::numeric_limits<G4double>::max_digits10);
+
+        // One line per input and bin
+        for (const auto& response : fResponse)
+        {
+            for (std::size_t i = 0; i < response.size(); i++)
+            {
+                file << response[i] << (((i + 1) % (RunAction::kMaxHisto * fNbOfBins)) ? ' ' : '\n');
+            }
+        }
+        fTransmission->Write(file);
+        return static_cast<G4bool>(file);
+    };
+
+    if (!CacheFiles::Write(fileName, write))
+    {
+        G4cout << "Warning: response matrix could not be written to " << fileName << G4endl;
+    }
+}
+
+void ResponseMatrix::SetResponse(G4int input, G4int inBin, const Spectra& out)
+{
+    auto& response = fResponse[input];
+
+    for (G4int outSlot = 0; outSlot < RunAction::kMaxHisto; outSlot++)
+    {
+        if (out[outSlot].empty()) continue;
+        for (G4int outBin = 0; outBin < fNbOfBins; outBin++)
+        {
+            response[GetIndex(inBin, outSlot, outBin)] = out[outSlot][outBin];
+        }
+    }
+}
+
+ResponseMatrix::Spectra ResponseMatrix::MakeSpectra() const
+{
+    Spectra spectra;
+    for (auto& spectrum : spectra) spectrum.assign(fNbOfBins, 0.0);
+    return spectra;
+}
+
+ResponseMatrix::Spectra ResponseMatrix::Fold(const Spectra& in, G4double positronFraction) const
+{
+    auto out = MakeSpectra();
+
+    // Neutrinos go through
+    out[2] = in[2];
+
+    // Share of the spectrum of its slot for each input
+    const G4double share[kNbOfInputs] = { 1.0 - positronFraction, positronFraction, 1.0, 1.0 };
+
+    for (G4int input = 0; input < kNbOfInputs; input++)
+    {
+        const auto& response = fResponse[input];
+        for (G4int inBin = 0; inBin < fNbOfBins; inBin++)
+        {
+            auto weight = share[input] * in[kInputSlots[input]][inBin];
+            if (weight == 0.0) continue;
+
+            for (G4int outSlot = 0; outSlot < RunAction::kMaxHisto; outSlot++)
+            {
+                auto row = &response[GetIndex(inBin, outSlot, 0)];
+                auto& spectrum = out[outSlot];
+                for (G4int outBin = 0; outBin < fNbOfBins; outBin++)
+                {
+                    spectrum[outBin] += weight * row[outBin];
+                }
+            }
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,157 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ResponseMessenger.cpp
+/// \brief Implementation of the ResponseMessenger class
+
+#include "ResponseMessenger.h"
+#include "ResponseManager.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
+
+ResponseMessenger::ResponseMessenger(ResponseManager* manager)
+    : fResponseManager(manager)
+{
+    fDirectory = new G4UIdirectory("/resp/", false);
+    fDirectory->SetGuidance("UI commands for the layer response matrices.");
+
+    fEnergyBinsCmd = new G4UIcommand("/resp/setEnergyBins", this);
+    fEnergyBinsCmd->SetGuidance("Set the energy bins of the responses, from 0 to the");
+    fEnergyBinsCmd->SetGuidance("maximum energy. The source spectra must be binned alike.");
+    auto nbPrm = new G4UIparameter("nbOfBins", 'i', false);
+    nbPrm->SetParameterRange("nbOfBins>0");
+    fEnergyBinsCmd->SetParameter(nbPrm);
+    auto energyPrm = new G4UIparameter("maxEnergy", 'd', false);
+    energyPrm->SetParameterRange("maxEnergy>0.");
+    fEnergyBinsCmd->SetParameter(energyPrm);
+    auto unitPrm = new G4UIparameter("unit", 's', true);
+    unitPrm->SetDefaultUnit("keV");
+    fEnergyBinsCmd->SetParameter(unitPrm);
+    fEnergyBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEventsPerBinCmd = new G4UIcmdWithAnInteger("/resp/setEventsPerBin", this);
+    fEventsPerBinCmd->SetGuidance("Set the number of events per particle type and energy bin");
+    fEventsPerBinCmd->SetGuidance("run to compute a response.");
+    fEventsPerBinCmd->SetParameterName("nb", false);
+    fEventsPerBinCmd->SetRange("nb>0");
+    fEventsPerBinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPositronFractionCmd = new G4UIcmdWithADouble("/resp/setPositronFraction", this);
+    fPositronFractionCmd->SetGuidance("Set the fraction of the e+ e- spectra folded as positrons,");
+    fPositronFractionCmd->SetGuidance("in front of every layer and of the detector (default 0).");
+    fPositronFractionCmd->SetParameterName("fraction", false);
+    fPositronFractionCmd->SetRange("fraction>=0. && fraction<=1.");
+    fPositronFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fComputeCmd = new G4UIcommand("/resp/compute", this);
+    fComputeCmd->SetGuidance("Load or compute the response of a layer.");
+    auto matPrm = new G4UIparameter("material", 's', false);
+    fComputeCmd->SetParameter(matPrm);
+    auto thickPrm = new G4UIparameter("thickness", 'd', false);
+    thickPrm->SetParameterRange("thickness>0.");
+    fComputeCmd->SetParameter(thickPrm);
+    auto thickUnitPrm = new G4UIparameter("unit", 's', true);
+    thickUnitPrm->SetDefaultUnit("mm");
+    fComputeCmd->SetParameter(thickUnitPrm);
+    fComputeCmd->AvailableForStates(G4State_Idle);
+
+    fEvaluateCmd = new G4UIcommand("/resp/evaluate", this);
+    fEvaluateCmd->SetGuidance("Fold the source spectra of a run summary through the stack");
+    fEvaluateCmd->SetGuidance("candidates of a file, one per line:");
+    fEvaluateCmd->SetGuidance("  name material thickness unit [material thickness unit ...]");
+    fEvaluateCmd->SetGuidance("The transmitted spectra are written to a CSV file.");
+    fEvaluateCmd->SetParameter(new G4UIparameter("stackFile", 's', false));
+    fEvaluateCmd->SetParameter(new G4UIparameter("sourceSummary", 's', false));
+    fEvaluateCmd->SetParameter(new G4UIparameter("outputFile", 's', false));
+    fEvaluateCmd->AvailableForStates(G4State_Idle);
+
+    fPrepareFastSimCmd = new G4UIcommand("/resp/prepareFastSim", this);
+    fPrepareFastSimCmd->SetGuidance("Load or compute the responses of the absorbers simulated fast");
+    fPrepareFastSimCmd->SetGuidance("and publish their transmission tables for the next runs.");
+    fPrepareFastSimCmd->SetGuidance("Photons above the maximum energy of the responses are fully simulated.");
+    fPrepareFastSimCmd->AvailableForStates(G4State_Idle);
+}
+
+ResponseMessenger::~ResponseMessenger()
+{
+    delete fEnergyBinsCmd;
+    delete fEventsPerBinCmd;
+    delete fPositronFractionCmd;
+    delete fComputeCmd;
+    delete fEvaluateCmd;
+    delete fPrepareFastSimCmd;
+    delete fDirectory;
+}
+
+void ResponseMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fEnergyBinsCmd)
+    {
+        G4int nbOfBins = 0;
+        G4double energy = 0.0;
+        G4String unit;
+        std::istringstream is(newValue);
+        is >> nbOfBins >> energy >> unit;
+        fResponseManager->SetEnergyBins(nbOfBins, energy * G4UIcommand::ValueOf(unit));
+    }
+
+    if (command == fEventsPerBinCmd)
+    {
+        fResponseManager->SetEventsPerBin(fEventsPerBinCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fPositronFractionCmd)
+    {
+        fResponseManager->SetPositronFraction(fPositronFractionCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fComputeCmd)
+    {
+        G4String mat, unit;
+        G4double thick = 0.0;
+        std::istringstream is(newValue);
+        is >> mat >> thick >> unit;
+        fResponseManager->GetResponse(mat, thick * G4UIcommand::ValueOf(unit));
+    }
+
+    if (command == fEvaluateCmd)
+    {
+        G4String stackFile, sourceFile, outputFile;
+        std::istringstream is(newValue);
+        is >> stackFile >> sourceFile >> outputFile;
+        fResponseManager->Evaluate(stackFile, sourceFile, outputFile);
+    }
+
+    if (command == fPrepareFastSimCmd)
+    {
+        fResponseManager->PrepareFastSimulation();
+    }
+}
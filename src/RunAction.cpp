@@ -28,14 +28,41 @@
 /// \brief Implementation of the RunAction class
 
 #include "RunAction.h"
+#include "RunMessenger.h"
 #include "PrimaryGeneratorAction.h"
+#include "SteppingAction.h"
+#include "InitializationMonitor.h"
+#include "PhaseSpaceReader.h"
 
-//#include "G4RunManager.hh"
+#include "G4RunManager.hh"
 #include "G4Run.hh"
 #include "G4AnalysisManager.hh"
 #include "G4AccumulableManager.hh"
+#include "G4HnInformation.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4ParticleTypes.hh"
+
+#include "tools/histo/h1d"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+G4String RunAction::fOutputDirectory;
+G4int RunAction::fShardIndex = 0;
+G4int RunAction::fShardCount = 0;
+G4long RunAction::fBaseSeed = 0;
+G4long RunAction::fSeed = 0;
+
+void RunAction::SetShard(G4int index, G4int count, G4long baseSeed, G4long seed)
+{
+    fShardIndex = index;
+    fShardCount = count;
+    fBaseSeed = baseSeed;
+    fSeed = seed;
+}
 
 RunAction::RunAction()
 {
@@ -43,6 +70,17 @@ RunAction::RunAction()
     // The choice of the output format is done via the specified
     // file extension.
     auto analysisManager = G4AnalysisManager::Instance();
+    fAnalysisManager = analysisManager;
+
+    fMessenger = new RunMessenger(this);
+    ClearTargets();
+
+    fPhaseSpace = new PhaseSpaceWriter;
+    fProfiler = new Profiler;
+
+    // A worker run action is created before the thread initializes
+    // its geometry and its physics
+    if (!IsMaster()) fInitTimer.Start();
 
     // Create directories
     analysisManager->SetDefaultFileType("root");
@@ -52,7 +90,6 @@ RunAction::RunAction()
     // Note: merging ntuples is available only with Root output
 
     // Define histograms start values
-    constexpr G4int kMaxHisto = 6;
     const G4String id[] = { "0","1","2","3","4","5" };
     const G4String title[] =
     {
@@ -83,21 +120,113 @@ RunAction::RunAction()
     for (G4int i = 0; i < fEkin.size(); i++)
     {
         accumulableManager->RegisterAccumulable(fEkin[i]);
+        accumulableManager->RegisterAccumulable(fEkin2[i]);
+        accumulableManager->RegisterAccumulable(fSum2[i]);
     }
 }
 
+RunAction::~RunAction()
+{
+    if (fOwnsPrimaryGenerator) delete fPrimaryGenerator;
+    if (!fSteppingActionRegistered) delete fSteppingAction;
+    delete fProfiler;
+    delete fPhaseSpace;
+    delete fMessenger;
+}
+
 void RunAction::BeginOfRunAction(const G4Run* aRun)
 {
+    if (!IsMaster() && !fInitTimed)
+    {
+        fInitTimer.Stop();
+        fInitTimed = true;
+        InitializationMonitor::AddWorkerInitTime(fInitTimer.GetRealElapsed());
+    }
+
+    // Geometry and options of the stepping action for this run; without
+    // any, it is unregistered so that the steps do not call it at all
+    if (fSteppingAction)
+    {
+        fSteppingAction->BeginOfRun();
+        G4bool needed = fSteppingAction->IsNeeded();
+        if (needed != fSteppingActionRegistered)
+        {
+            G4UserSteppingAction* action = needed ? fSteppingAction : nullptr;
+            G4RunManager::GetRunManager()->SetUserAction(action);
+            fSteppingActionRegistered = needed;
+        }
+    }
+
+    // Source tables, built by the master before the workers start
+    if (fPrimaryGenerator) fPrimaryGenerator->PrepareRun();
+
     // Get analysis manager
     auto analysisManager = G4AnalysisManager::Instance();
 
     // Open an output file
     //
+    auto fileName = analysisManager->GetFileName();
+    auto outputFileName = GetOutputFileName(fileName);
+    if (outputFileName != fileName) analysisManager->SetFileName(outputFileName);
     analysisManager->OpenFile();
 
     // Reset accumulables to their initial values
     auto accumulableManager = G4AccumulableManager::Instance();
     accumulableManager->Reset();
+
+    // Histograms deactivated in the macro are skipped when scoring,
+    // the active ones are filled through the thread-local buffers
+    for (G4int ih = 0; ih < kMaxHisto; ih++)
+    {
+        fActive[ih] = analysisManager->GetH1Activation(ih);
+        fBuffered[ih] = fActive[ih] && ConfigureBuffer(ih);
+        if (IsMaster() && ih > 0 && fActive[ih] && !fBuffered[ih])
+        {
+            G4cout
+                << "Warning: spectrum " << ih << " is not fixed-bin, its errors are"
+                << " estimated per particle, not per history" << G4endl;
+        }
+    }
+    fEventEkin.fill(0.0);
+
+    // Particle lookup, ions are added on first use
+    fSlots.clear();
+    fSlots[G4Electron::Electron()] = 1;
+    fSlots[G4Positron::Positron()] = 1;
+    fSlots[G4NeutrinoE::NeutrinoE()] = 2;
+    fSlots[G4AntiNeutrinoE::AntiNeutrinoE()] = 2;
+    fSlots[G4Gamma::Gamma()] = 3;
+    fSlots[G4Alpha::Alpha()] = 4;
+    fLastParticle = nullptr;
+    fLastSlot = 0;
+
+    // The master configures the shared monitor before the workers
+    // start, then each thread scoring events registers to it
+    auto monitor = ConvergenceMonitor::Instance();
+    if (IsMaster()) monitor->Configure(fTargets);
+    G4bool scoring = !IsMaster() || !G4Threading::IsMultithreadedApplication();
+    fMonitorSlot = (scoring && fTargets.IsActive()) ? monitor->Register() : -1;
+    fNofEvents = 0;
+
+    // Phase space, one file per run and per scoring thread; the
+    // crossings of a plane are recorded by the stepping action
+    fRecordDetectorEntry = fPhaseSpace->GetPlaneMode() == PhaseSpaceWriter::kDetectorEntry;
+    if (scoring && fPhaseSpace->IsEnabled())
+    {
+        auto threadId = std::max(G4Threading::G4GetThreadId(), 0);
+        fPhaseSpace->Open(analysisManager->GetFileName()
+            + "_run" + std::to_string(aRun->GetRunID())
+            + "_t" + std::to_string(threadId) + ".phsp");
+    }
+
+    if (scoring && fProfiler->IsEnabled()) fProfiler->BeginOfRun();
+    if (scoring && SlabTransmission::Tally::IsEnabled()) fTransmissionTally.BeginOfRun();
+
+    // The master marks the start of the run before the workers start
+    if (IsMaster()) RunTelemetry::StartRun();
+    if (scoring) fTelemetry.BeginOfRun();
+
+    fTimer.Start();
 }
 
 void RunAction::EndOfRunAction(const G4Run* aRun)
@@ -105,24 +234,77 @@ void RunAction::EndOfRunAction(const G4Run* aRun)
     // Get analysis manager
     auto analysisManager = G4AnalysisManager::Instance();
 
+    fTimer.Stop();
+    G4int nofEvents = aRun->GetNumberOfEvent();
+
+    // Wait for the last block of the phase space
+    fPhaseSpace->Close();
+
+    // The worker histograms are merged into the master ones by the time
+    // the master ends its run; the statistics are taken before they are
+    // reset by CloseFile()
+    FlushHistograms();
+
+    // Merge accumulables
+    auto accumulableManager = G4AccumulableManager::Instance();
+    if (nofEvents > 0) accumulableManager->Merge();
+
+    if (IsMaster() && nofEvents > 0 && fVerboseLevel > 0)
+    {
+        auto monitor = ConvergenceMonitor::Instance();
+        if (monitor->IsConverged())
+        {
+            G4cout
+                << G4endl
+                << " Precision targets met after " << monitor->GetConvergedEvents()
+                << " events, the run was stopped." << G4endl;
+        }
+        PrintStatistics(fTimer.GetRealElapsed());
+    }
+
+    if (IsMaster() && nofEvents > 0) WriteSummary(GetNbOfHistories(aRun));
+
+    // Step profile, merged over the threads before the master reports it
+    if (fProfiler->IsEnabled())
+    {
+        G4bool scoring = !IsMaster() || !G4Threading::IsMultithreadedApplication();
+        if (scoring) fProfiler->Merge();
+        if (IsMaster()) fProfiler->Report(analysisManager->GetFileName() + "_profile.csv");
+    }
+
+    // Transmission of the photons, merged over the threads before the
+    // response manager takes it
+    if (SlabTransmission::Tally::IsEnabled()
+        && (!IsMaster() || !G4Threading::IsMultithreadedApplication()))
+    {
+        fTransmissionTally.Merge(nofEvents);
+    }
+
+    // Throughput of the threads
+    if (!IsMaster() || !G4Threading::IsMultithreadedApplication()) fTelemetry.EndOfRun();
+    if (IsMaster() && nofEvents > 0)
+    {
+        RunTelemetry::Report(analysisManager->GetFileName() + "_telemetry.json",
+            aRun->GetRunID(), fTimer.GetRealElapsed(), fVerboseLevel > 0);
+    }
+
     // Save histograms
     //
     analysisManager->Write();
     analysisManager->CloseFile();
 
-    G4int nofEvents = aRun->GetNumberOfEvent();
     if (nofEvents == 0) return;
 
-    // Merge accumulables
-    auto accumulableManager = G4AccumulableManager::Instance();
-    accumulableManager->Merge();
-
     // Compute Kinetic Energy
-    auto electronEkin = fEkin[1].GetValue();
-    auto neutrinoEkin = fEkin[2].GetValue();
-    auto gammaEkin = fEkin[3].GetValue();
-    auto alphaEkin = fEkin[4].GetValue();
-    auto ionEkin = fEkin[5].GetValue();
+    const char* ekinName[] =
+    {
+        "",
+        "electron and positron",
+        "neutrino and antineutrino",
+        "gamma",
+        "alpha",
+        "ion"
+    };
 
     // Print
     //
@@ -142,25 +324,306 @@ void RunAction::EndOfRunAction(const G4Run* aRun)
     G4cout
         << G4endl
         << " The run consists of " << nofEvents << " primary events."
+        << G4endl;
+
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        auto ekin = fEkin[ih].GetValue();
+        auto ekin2 = fEkin2[ih].GetValue();
+        G4cout
+            << " The total " << ekinName[ih] << " kinetic energy is "
+            << G4BestUnit(ekin, "Energy");
+        if (ekin > 0.0)
+        {
+            G4cout << " (rel. error " << std::sqrt(ekin2) / ekin << ")";
+        }
+        G4cout << "." << G4endl;
+    }
+}
+
+namespace
+{
+// The dimension information is returned by pointer or by reference
+// depending on the Geant4 version
+const G4HnDimensionInformation& DimensionInfo(const G4HnDimensionInformation& info)
+{
+    return info;
+}
+
+const G4HnDimensionInformation& DimensionInfo(const G4HnDimensionInformation* info)
+{
+    return *info;
+}
+}
+
+G4bool RunAction::ConfigureBuffer(G4int ih)
+{
+    auto info = fAnalysisManager->GetH1Information(ih);
+    if (!info) return false;
+
+    const auto& xInfo = DimensionInfo(info->GetHnDimensionInformation(G4Analysis::kX));
+    G4bool identityFcn = (xInfo.fFcnName == "none")
+        && (xInfo.fBinScheme == G4BinScheme::kLinear);
+
+    return fBuffers[ih].Configure(fAnalysisManager->GetH1(ih), xInfo.fUnit, identityFcn);
+}
+
+void RunAction::FlushHistograms()
+{
+    for (G4int ih = 0; ih < kMaxHisto; ih++)
+    {
+        if (fBuffered[ih]) fBuffers[ih].FlushTo(fAnalysisManager->GetH1(ih));
+    }
+}
+
+void RunAction::ClearTargets()
+{
+    fTargets.relError.assign(kMaxHisto, -1.0);
+    fTargets.binRelError.assign(kMaxHisto, -1.0);
+    fTargets.entries.assign(kMaxHisto, -1.0);
+}
+
+void RunAction::BeginOfEvent(G4int eventID)
+{
+    fEventID = eventID;
+    fTelemetry.BeginOfEvent();
+    if (fProfiler->IsEnabled()) fProfiler->BeginOfEvent();
+}
+
+void RunAction::EndOfEvent()
+{
+    // Close the history: its sums are squared once
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        if (fBuffered[ih])
+        {
+            G4double sum = fBuffers[ih].EndOfEvent();
+            fSum2[ih] += sum * sum;
+        }
+        fEkin2[ih] += fEventEkin[ih] * fEventEkin[ih];
+        fEventEkin[ih] = 0.0;
+    }
+
+    fTelemetry.EndOfEvent();
+    if (fPhaseSpace->IsOpen()) fPhaseSpace->EndOfEvent();
+
+    if (fMonitorSlot < 0) return;
+    if (++fNofEvents % fTargets.checkInterval == 0) Checkpoint();
+}
+
+void RunAction::Checkpoint()
+{
+    // Totals of the run so far: what was already flushed into the
+    // thread-local histograms plus the content of the buffers
+    fContribution.nofEvents = fNofEvents;
+    fContribution.spectra.resize(kMaxHisto);
+
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        auto& spectrum = fContribution.spectra[ih];
+        auto h1 = fActive[ih] ? fAnalysisManager->GetH1(ih) : nullptr;
+        if (!h1)
+        {
+            spectrum = ConvergenceMonitor::Spectrum();
+            continue;
+        }
+
+        G4int nbins = h1->axis().bins();
+        spectrum.entries.assign(nbins, 0.0);
+        spectrum.sw.assign(nbins, 0.0);
+        spectrum.sw2.assign(nbins, 0.0);
+        spectrum.sum2 = GetSum2(ih, h1);
+
+        const auto& entries = h1->bins_entries();
+        const auto& sw = h1->bins_sum_w();
+        const auto& sw2 = h1->bins_sum_w2();
+        for (G4int ibin = 1; ibin <= nbins; ibin++)
+        {
+            spectrum.entries[ibin - 1] = entries[ibin];
+            spectrum.sw[ibin - 1] = sw[ibin];
+            spectrum.sw2[ibin - 1] = sw2[ibin];
+        }
+
+        if (!fBuffered[ih]) continue;
+        const auto& bins = fBuffers[ih].GetBins();
+        for (G4int ibin = 1; ibin <= nbins && ibin < static_cast<G4int>(bins.size()); ibin++)
+        {
+            spectrum.entries[ibin - 1] += bins[ibin].entries;
+            spectrum.sw[ibin - 1] += bins[ibin].sw;
+            spectrum.sw2[ibin - 1] += bins[ibin].sw2;
+        }
+    }
+
+    ConvergenceMonitor::Instance()->Publish(fMonitorSlot, fContribution);
+}
+
+G4double RunAction::GetSum2(G4int ih, const tools::histo::h1d* h1) const
+{
+    // Per history for the buffered spectra; otherwise the squared
+    // weights of the particles, summed over the bins in range
+    if (fBuffered[ih]) return fSum2[ih].GetValue();
+
+    const auto& sw2 = h1->bins_sum_w2();
+    G4double sum2 = 0.0;
+    for (G4int ibin = 1; ibin <= static_cast<G4int>(h1->axis().bins()); ibin++) sum2 += sw2[ibin];
+    return sum2;
+}
+
+G4long RunAction::GetNbOfHistories(const G4Run* aRun) const
+{
+    // A replay stands for the histories of the recording runs in the
+    // blocks it took, whatever the recycling of its events
+    G4bool complete = false;
+    auto nofHistories = PhaseSpaceReader::Instance()->GetNbOfHistories(aRun->GetRunID(), complete);
+    if (nofHistories < 0) return aRun->GetNumberOfEvent();
+
+    if (!complete)
+    {
+        G4cout
+            << "Warning: the phase space was not replayed to its end, the summary"
+            << " is normalized to the histories of the blocks taken." << G4endl;
+    }
+    return nofHistories;
+}
+
+G4String RunAction::GetOutputFileName(const G4String& fileName) const
+{
+    // The decorations are added once, the file name is kept between runs
+    G4String outputFileName = fileName;
+
+    if (fShardCount > 0)
+    {
+        auto suffix = "_shard" + std::to_string(fShardIndex) + "of" + std::to_string(fShardCount);
+        if (!G4StrUtil::ends_with(outputFileName, suffix)) outputFileName += suffix;
+    }
+
+    if (!fOutputDirectory.empty())
+    {
+        auto prefix = fOutputDirectory + "/";
+        if (!G4StrUtil::starts_with(outputFileName, prefix)) outputFileName = prefix + outputFileName;
+    }
+
+    return outputFileName;
+}
+
+void RunAction::WriteSummary(G4long nofEvents) const
+{
+    // Plain text, one record per line:
+    //   shard index count, seed base seed, events n,
+    //   ekin ih sum sum2, sum ih sw sw2, h1 ih nbins edges...,
+    //   bin ibin entries sw sw2 sxw sx2w
+    // with the underflow and overflow bins 0 and nbins+1; sum holds the
+    // integral of a spectrum in range and its sum of squares per history
+    // The events of a phase space replay are the recorded histories
+    auto fileName = fAnalysisManager->GetFileName() + ".summary";
+    std::ofstream summary(fileName);
+    if (!summary)
+    {
+        G4cout << "Warning: cannot write the run summary " << fileName << G4endl;
+        return;
+    }
+
+    summary << std::setprecision(17);
+    summary << "# absorber run summary" << '\n';
+    summary << "shard " << fShardIndex << ' ' << std::max(fShardCount, 1) << '\n';
+    summary << "seed " << fBaseSeed << ' ' << fSeed << '\n';
+    summary << "events " << nofEvents << '\n';
+
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        summary << "ekin " << ih << ' ' << fEkin[ih].GetValue() << ' ' << fEkin2[ih].GetValue() << '\n';
+    }
+
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        if (!fActive[ih]) continue;
+        auto h1 = fAnalysisManager->GetH1(ih);
+        if (!h1) continue;
+
+        const auto& axis = h1->axis();
+        G4int nbins = axis.bins();
+        summary << "h1 " << ih << ' ' << nbins;
+        for (G4int ibin = 0; ibin < nbins; ibin++) summary << ' ' << axis.bin_lower_edge(ibin);
+        summary << ' ' << axis.bin_upper_edge(nbins - 1) << '\n';
+
+        const auto& entries = h1->bins_entries();
+        const auto& sw = h1->bins_sum_w();
+        const auto& sw2 = h1->bins_sum_w2();
+        const auto& sxw = h1->bins_sum_xw();
+
+        G4double sum = 0.0;
+        for (G4int ibin = 1; ibin <= nbins; ibin++) sum += sw[ibin];
+        summary << "sum " << ih << ' ' << sum << ' ' << GetSum2(ih, h1) << '\n';
+
+        const auto& sx2w = h1->bins_sum_x2w();
+        for (G4int ibin = 0; ibin <= nbins + 1; ibin++)
+        {
+            summary
+                << "bin " << ibin << ' ' << entries[ibin] << ' ' << sw[ibin] << ' ' << sw2[ibin]
+                << ' ' << sxw[ibin][0] << ' ' << sx2w[ibin][0] << '\n';
+        }
+    }
+}
+
+void RunAction::PrintStatistics(G4double time) const
+{
+    // Relative errors are sqrt(sum w^2)/(sum w), with the squares taken
+    // per history, the figure of merit of a spectrum is 1/(R^2 T) with R
+    // the relative error of its integral and T the wall time of the run
+    G4cout
         << G4endl
-        << " The total electron and positron kinetic energy is "
-        << G4BestUnit(electronEkin, "Energy") << "."
-        << G4endl
-        << " The total neutrion and antineutrion kinetic energy is "
-        << G4BestUnit(neutrinoEkin, "Energy") << "."
-        << G4endl
-        << " The total gamma kinetic energy is "
-        << G4BestUnit(gammaEkin, "Energy") << "."
-        << G4endl
-        << " The total alpha kinetic energy is "
-        << G4BestUnit(alphaEkin, "Energy") << "."
+        << "--------------------Statistics------------------------------"
         << G4endl
-        << " The total ion kinetic energy is "
-        << G4BestUnit(ionEkin, "Energy") << "."
-        << G4endl;
+        << " Wall time of the run: " << time << " s" << G4endl;
+
+    for (G4int ih = 1; ih < kMaxHisto; ih++)
+    {
+        if (!fActive[ih]) continue;
+        auto h1 = fAnalysisManager->GetH1(ih);
+        if (!h1) continue;
+
+        const auto& sw = h1->bins_sum_w();
+        const auto& sw2 = h1->bins_sum_w2();
+        G4int nbins = h1->axis().bins();
+
+        G4double sum = 0.0;
+        G4double sum2 = GetSum2(ih, h1);
+        G4double maxRelErr = 0.0;
+        for (G4int ibin = 1; ibin <= nbins; ibin++)
+        {
+            if (sw[ibin] <= 0.0) continue;
+            sum += sw[ibin];
+            maxRelErr = std::max(maxRelErr, std::sqrt(sw2[ibin]) / sw[ibin]);
+        }
+
+        G4double relErr = (sum > 0.0) ? std::sqrt(sum2) / sum : 0.0;
+        G4double fom = (relErr > 0.0 && time > 0.0) ? 1.0 / (relErr * relErr * time) : 0.0;
+
+        G4cout
+            << " Spectrum " << ih << ": sum of weights " << sum
+            << ", rel. error " << relErr
+            << ", max bin rel. error " << maxRelErr
+            << ", FOM " << fom << " /s" << G4endl;
+
+        if (fVerboseLevel < 2) continue;
+
+        const auto& axis = h1->axis();
+        for (G4int ibin = 1; ibin <= nbins; ibin++)
+        {
+            if (sw[ibin] <= 0.0) continue;
+            G4cout
+                << "   bin " << std::setw(4) << ibin - 1
+                << " [" << axis.bin_lower_edge(ibin - 1)
+                << ", " << axis.bin_upper_edge(ibin - 1) << "]"
+                << " sum " << sw[ibin]
+                << " rel. error " << std::sqrt(sw2[ibin]) / sw[ibin] << G4endl;
+        }
+    }
 }
 
-void RunAction::AddEkin(G4int ih, G4double ekin)
+G4int RunAction::ClassifyParticle(const G4ParticleDefinition* particle)
 {
-    fEkin[ih] += ekin;
+    G4int ih = (particle->GetPDGCharge() > 2.0) ? 5 : 0;
+    fSlots[particle] = ih;
+    return ih;
 }
@@ -0,0 +1,145 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/RunMessenger.cpp
+/// \brief Implementation of the RunMessenger class
+
+#include "RunMessenger.h"
+#include "RunAction.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
+
+namespace
+{
+G4UIcommand* CreateTargetCommand(const char* name, const char* guidance,
+    G4UImessenger* messenger)
+{
+    auto command = new G4UIcommand(name, messenger);
+    command->SetGuidance(guidance);
+    command->SetGuidance("Spectrum 1-5, a negative value disables the target.");
+    auto spectrumPrm = new G4UIparameter("spectrum", 'i', false);
+    spectrumPrm->SetParameterRange("spectrum>0 && spectrum<6");
+    command->SetParameter(spectrumPrm);
+    auto valuePrm = new G4UIparameter("value", 'd', false);
+    command->SetParameter(valuePrm);
+    command->AvailableForStates(G4State_PreInit, G4State_Idle);
+    return command;
+}
+}
+
+RunMessenger::RunMessenger(RunAction* run)
+    : fRunAction(run)
+{
+    fDirectory = new G4UIdirectory("/stat/");
+    fDirectory->SetGuidance("UI commands for the run statistics.");
+
+    fVerboseCmd = new G4UIcmdWithAnInteger("/stat/verbose", this);
+    fVerboseCmd->SetGuidance("Set the verbose level of the end of run statistics:");
+    fVerboseCmd->SetGuidance("  0 : none, 1 : per spectrum, 2 : per bin.");
+    fVerboseCmd->SetParameterName("level", false);
+    fVerboseCmd->SetRange("level>=0");
+    fVerboseCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fTargetRelErrorCmd = CreateTargetCommand("/stat/targetRelError",
+        "Stop the run once the relative error of the spectrum integral is below value.",
+        this);
+
+    fTargetBinRelErrorCmd = CreateTargetCommand("/stat/targetBinRelError",
+        "Stop the run once the relative error of every filled bin is below value.",
+        this);
+
+    fTargetEntriesCmd = CreateTargetCommand("/stat/targetEntries",
+        "Stop the run once the spectrum has at least value entries.",
+        this);
+
+    fMinEventsCmd = new G4UIcmdWithAnInteger("/stat/minEvents", this);
+    fMinEventsCmd->SetGuidance("Set the number of events before the targets are checked.");
+    fMinEventsCmd->SetParameterName("nb", false);
+    fMinEventsCmd->SetRange("nb>=0");
+    fMinEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCheckIntervalCmd = new G4UIcmdWithAnInteger("/stat/checkInterval", this);
+    fCheckIntervalCmd->SetGuidance("Set the number of events of a thread between two checkpoints.");
+    fCheckIntervalCmd->SetParameterName("nb", false);
+    fCheckIntervalCmd->SetRange("nb>0");
+    fCheckIntervalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fClearTargetsCmd = new G4UIcmdWithoutParameter("/stat/clearTargets", this);
+    fClearTargetsCmd->SetGuidance("Disable all precision targets: runs process all their events.");
+    fClearTargetsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+RunMessenger::~RunMessenger()
+{
+    delete fVerboseCmd;
+    delete fTargetRelErrorCmd;
+    delete fTargetBinRelErrorCmd;
+    delete fTargetEntriesCmd;
+    delete fMinEventsCmd;
+    delete fCheckIntervalCmd;
+    delete fClearTargetsCmd;
+    delete fDirectory;
+}
+
+void RunMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fVerboseCmd)
+    {
+        fRunAction->SetVerboseLevel(fVerboseCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fTargetRelErrorCmd || command == fTargetBinRelErrorCmd
+        || command == fTargetEntriesCmd)
+    {
+        G4int ih = 0;
+        G4double value = 0.0;
+        std::istringstream is(newValue);
+        is >> ih >> value;
+        if (command == fTargetRelErrorCmd) fRunAction->SetTargetRelError(ih, value);
+        if (command == fTargetBinRelErrorCmd) fRunAction->SetTargetBinRelError(ih, value);
+        if (command == fTargetEntriesCmd) fRunAction->SetTargetEntries(ih, value);
+    }
+
+    if (command == fMinEventsCmd)
+    {
+        fRunAction->SetMinEvents(fMinEventsCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fCheckIntervalCmd)
+    {
+        fRunAction->SetCheckInterval(fCheckIntervalCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fClearTargetsCmd)
+    {
+        fRunAction->ClearTargets();
+    }
+}
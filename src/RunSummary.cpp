@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/RunSummary.cpp
+/// \brief Implementation of the RunSummary class
+
+#include "RunSummary.h"
+
+#include <fstream>
+#include <sstream>
+
+G4bool RunSummary::Read(const G4String& fileName)
+{
+    std::ifstream input(fileName);
+    if (!input) return false;
+
+    Spectrum* spectrum = nullptr;
+    G4String line;
+    while (std::getline(input, line))
+    {
+        std::istringstream is(line);
+        G4String key;
+        is >> key;
+
+        if (key == "shard")
+        {
+            is >> shardIndex >> shardCount;
+        }
+        else if (key == "shards")
+        {
+            shardIndices.clear();
+            G4int index = 0;
+            while (is >> index) shardIndices.push_back(index);
+        }
+        else if (key == "seed")
+        {
+            is >> baseSeed >> seed;
+        }
+        else if (key == "events")
+        {
+            is >> nofEvents;
+        }
+        else if (key == "ekin" || key == "sum")
+        {
+            G4int ih = 0;
+            std::array<G4double, 2> values{};
+            is >> ih >> values[0] >> values[1];
+            (key == "ekin" ? ekin : sums)[ih] = values;
+        }
+        else if (key == "h1")
+        {
+            G4int ih = 0;
+            is >> ih;
+            spectrum = &spectra[ih];
+            is >> spectrum->nbins;
+            spectrum->edges.clear();
+            G4double edge = 0.0;
+            while (is >> edge) spectrum->edges.push_back(edge);
+            spectrum->bins.assign(spectrum->nbins + 2, Bin{});
+        }
+        else if (key == "bin" && spectrum)
+        {
+            std::size_t ibin = 0;
+            is >> ibin;
+            if (spectrum->bins.size() <= ibin) spectrum->bins.resize(ibin + 1, Bin{});
+            for (auto& value : spectrum->bins[ibin]) is >> value;
+        }
+    }
+
+    if (shardIndices.empty() && shardIndex >= 0) shardIndices.push_back(shardIndex);
+    return true;
+}
@@ -0,0 +1,193 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/RunTelemetry.cpp
+/// \brief Implementation of the RunTelemetry class
+
+#include "RunTelemetry.h"
+#include "InitializationMonitor.h"
+
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+namespace
+{
+G4Mutex mergeMutex = G4MUTEX_INITIALIZER;
+
+// Counters of all the threads of the run
+std::vector<RunTelemetry::Counters> merged;
+
+// Time per event below which the given fraction of the events are
+// (at the geometric centre of the histogram bin)
+G4double Percentile(const std::array<G4long, RunTelemetry::kNbOfBins>& times,
+    G4long nbOfEvents, G4double fraction)
+{
+    G4long count = 0;
+    for (G4int bin = 0; bin < RunTelemetry::kNbOfBins; bin++)
+    {
+        count += times[bin];
+        if (count >= fraction * nbOfEvents)
+        {
+            return RunTelemetry::kMinTime
+                * std::pow(10.0, (bin + 0.5) / RunTelemetry::kBinsPerDecade);
+        }
+    }
+    return 0.0;
+}
+}
+
+RunTelemetry::Clock::time_point RunTelemetry::fRunStart;
+
+void RunTelemetry::StartRun()
+{
+    G4AutoLock lock(&mergeMutex);
+    fRunStart = Clock::now();
+    merged.clear();
+}
+
+void RunTelemetry::BeginOfRun()
+{
+    fCounters = Counters();
+    fCounters.threadId = std::max(G4Threading::G4GetThreadId(), 0);
+    fBeginOfRun = Clock::now();
+}
+
+void RunTelemetry::EndOfRun()
+{
+    fCounters.wallTime = Seconds(Clock::now() - fBeginOfRun);
+
+    G4AutoLock lock(&mergeMutex);
+    merged.push_back(fCounters);
+}
+
+void RunTelemetry::Report(const G4String& fileName, G4int runID, G4double wallTime,
+    G4bool print)
+{
+    G4AutoLock lock(&mergeMutex);
+    if (merged.empty()) return;
+
+    std::sort(merged.begin(), merged.end(), [](const Counters& a, const Counters& b)
+        { return a.threadId < b.threadId; });
+
+    // Run totals
+    Counters total;
+    G4double maxBusyTime = 0.0;
+    for (const auto& counters : merged)
+    {
+        total.events += counters.events;
+        total.steps += counters.steps;
+        total.busyTime += counters.busyTime;
+        total.maxEventTime = std::max(total.maxEventTime, counters.maxEventTime);
+        for (G4int bin = 0; bin < kNbOfBins; bin++) total.eventTimes[bin] += counters.eventTimes[bin];
+        maxBusyTime = std::max(maxBusyTime, counters.busyTime);
+    }
+
+    auto rate = [](G4double count, G4double time) { return time > 0.0 ? count / time : 0.0; };
+    G4double meanBusyTime = total.busyTime / merged.size();
+    G4double imbalance = rate(maxBusyTime, meanBusyTime);
+    G4double meanEventTime = rate(total.busyTime, total.events);
+    G4double p50 = Percentile(total.eventTimes, total.events, 0.50);
+    G4double p90 = Percentile(total.eventTimes, total.events, 0.90);
+    G4double p99 = Percentile(total.eventTimes, total.events, 0.99);
+
+    if (print)
+    {
+        G4cout
+            << G4endl
+            << " Throughput: " << rate(total.events, wallTime) << " events/s, "
+            << rate(total.steps, wallTime) << " steps/s over " << wallTime << " s"
+            << G4endl
+            << " Time per event: mean " << meanEventTime << " s, median " << p50
+            << " s, 90% " << p90 << " s, 99% " << p99 << " s, max " << total.maxEventTime
+            << " s" << G4endl
+            << " Load imbalance (max/mean busy time): " << imbalance << G4endl
+            << std::setw(8) << "thread" << std::setw(12) << "events" << std::setw(14) << "steps"
+            << std::setw(12) << "events/s" << std::setw(12) << "busy [s]"
+            << std::setw(12) << "idle [s]" << std::setw(12) << "startup [s]" << G4endl;
+
+        for (const auto& counters : merged)
+        {
+            G4cout
+                << std::setw(8) << counters.threadId << std::setw(12) << counters.events
+                << std::setw(14) << counters.steps
+                << std::setw(12) << rate(counters.events, counters.busyTime)
+                << std::setw(12) << counters.busyTime
+                << std::setw(12) << counters.wallTime - counters.busyTime
+                << std::setw(12) << counters.startupTime << G4endl;
+        }
+    }
+
+    std::ofstream file(fileName);
+    file
+        << "{\n"
+        << "  \"run\": " << runID << ",\n"
+        << "  \"threads\": " << merged.size() << ",\n"
+        << "  \"events\": " << total.events << ",\n"
+        << "  \"steps\": " << total.steps << ",\n"
+        << "  \"wall_time_s\": " << wallTime << ",\n"
+        << "  \"events_per_s\": " << rate(total.events, wallTime) << ",\n"
+        << "  \"steps_per_s\": " << rate(total.steps, wallTime) << ",\n"
+        << "  \"master_kernel_init_time_s\": " << InitializationMonitor::GetKernelInitTime() << ",\n"
+        << "  \"master_first_run_init_time_s\": " << InitializationMonitor::GetRunInitTime() << ",\n"
+        << "  \"worker_init_time_s\": " << InitializationMonitor::GetWorkerInitTime() << ",\n"
+        << "  \"peak_memory_bytes\": " << InitializationMonitor::GetPeakMemory() << ",\n"
+        << "  \"load_imbalance\": " << imbalance << ",\n"
+        << "  \"event_time_s\": { \"mean\": " << meanEventTime << ", \"p50\": " << p50
+        << ", \"p90\": " << p90 << ", \"p99\": " << p99
+        << ", \"max\": " << total.maxEventTime << " },\n"
+        << "  \"per_thread\": [\n";
+
+    for (std::size_t i = 0; i < merged.size(); i++)
+    {
+        const auto& counters = merged[i];
+        file
+            << "    { \"thread\": " << counters.threadId
+            << ", \"events\": " << counters.events
+            << ", \"steps\": " << counters.steps
+            << ", \"wall_time_s\": " << counters.wallTime
+            << ", \"busy_time_s\": " << counters.busyTime
+            << ", \"idle_time_s\": " << counters.wallTime - counters.busyTime
+            << ", \"startup_time_s\": " << counters.startupTime
+            << ", \"events_per_s\": " << rate(counters.events, counters.busyTime)
+            << ", \"steps_per_s\": " << rate(counters.steps, counters.busyTime)
+            << ", \"max_event_time_s\": " << counters.maxEventTime
+            << " }" << (i + 1 < merged.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+
+    if (!file)
+    {
+        G4cout << "Warning: the telemetry could not be written to " << fileName << G4endl;
+    }
+
+    merged.clear();
+}
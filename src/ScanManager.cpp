@@ -0,0 +1,205 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ScanManager.cpp
+/// \brief Implementation of the ScanManager class
+
+#include "ScanManager.h"
+#include "ScanMessenger.h"
+#include "DetectorConstruction.h"
+#include "RunSummary.h"
+
+#include "G4UImanager.hh"
+#include "G4AnalysisManager.hh"
+#include "G4Timer.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <sstream>
+
+ScanManager::ScanManager(DetectorConstruction* det)
+    : fDetConstruction(det)
+{
+    fMessenger = new ScanMessenger(this);
+}
+
+ScanManager::~ScanManager()
+{
+    delete fMessenger;
+}
+
+void ScanManager::Clear()
+{
+    fMaterials.clear();
+    fThicknesses.clear();
+    fLayerCounts.clear();
+}
+
+void ScanManager::BeamOn(G4int nofEvents)
+{
+    if (fMaterials.empty() || fThicknesses.empty())
+    {
+        G4cout << "Warning: Scan needs at least one material and one thickness!"
+            << G4endl;
+        return;
+    }
+
+    std::vector<G4int> layerCounts = fLayerCounts;
+    if (layerCounts.empty()) layerCounts.push_back(1);
+
+    auto UImanager = G4UImanager::GetUIpointer();
+
+    G4int nofConfigs = fMaterials.size() * fThicknesses.size() * layerCounts.size();
+    G4int iConfig = 0;
+
+    for (const auto& mat : fMaterials)
+    {
+        for (auto thick : fThicknesses)
+        {
+            for (auto nb : layerCounts)
+            {
+                auto configName = GetConfigName(mat, thick, nb);
+                G4cout << G4endl << "Scan configuration " << ++iConfig << "/"
+                    << nofConfigs << ": " << configName << G4endl;
+
+                fDetConstruction->ClearAbsorbers();
+                for (G4int i = 0; i < nb; i++)
+                {
+                    fDetConstruction->AddAbsorber(mat, thick);
+                }
+
+                // Only the geometry is rebuilt, the physics tables of
+                // materials already in use are kept
+                UImanager->ApplyCommand("/run/reinitializeGeometry");
+                UImanager->ApplyCommand("/analysis/setFileName " + configName);
+                UImanager->ApplyCommand("/run/beamOn " + std::to_string(nofEvents));
+            }
+        }
+    }
+}
+
+void ScanManager::CompareFastSimulation(G4int nofEvents)
+{
+    if (!fDetConstruction->HasFastSimulationPhysics())
+    {
+        G4cout << "Warning: no fast simulation physics (absorber -f 1),"
+            << " nothing to compare!" << G4endl;
+        return;
+    }
+
+    auto UImanager = G4UImanager::GetUIpointer();
+    auto fastSimulation = fDetConstruction->GetFastSimulation();
+
+    // Same configuration, fully simulated then with the fast simulation
+    const G4String modeName[2] = { "full", "fast" };
+    RunSummary summaries[2];
+    G4double times[2] = { 0.0, 0.0 };
+
+    for (G4int mode = 0; mode < 2; mode++)
+    {
+        G4cout << G4endl << "Fast simulation comparison: " << modeName[mode]
+            << " simulation" << G4endl;
+
+        // The transmission tables are prepared out of the timed run
+        fDetConstruction->SetFastSimulation(mode == 1);
+        if (mode == 1) UImanager->ApplyCommand("/resp/prepareFastSim");
+        UImanager->ApplyCommand("/run/reinitializeGeometry");
+        UImanager->ApplyCommand("/analysis/setFileName " + fFileName + "_" + modeName[mode]);
+
+        G4Timer timer;
+        timer.Start();
+        UImanager->ApplyCommand("/run/beamOn " + std::to_string(nofEvents));
+        timer.Stop();
+        times[mode] = timer.GetRealElapsed();
+
+        auto fileName = G4AnalysisManager::Instance()->GetFileName() + ".summary";
+        if (!summaries[mode].Read(fileName) || summaries[mode].nofEvents <= 0)
+        {
+            G4cout << "Warning: run summary " << fileName << " cannot be read!" << G4endl;
+            fDetConstruction->SetFastSimulation(fastSimulation);
+            UImanager->ApplyCommand("/run/reinitializeGeometry");
+            return;
+        }
+    }
+
+    fDetConstruction->SetFastSimulation(fastSimulation);
+    UImanager->ApplyCommand("/run/reinitializeGeometry");
+
+    // Per spectrum: the totals per event and their difference in
+    // standard deviations, and the chi2 of the bins
+    G4cout
+        << G4endl
+        << "--------------------Fast simulation comparison--------------"
+        << G4endl
+        << " Wall time: full " << times[0] << " s, fast " << times[1] << " s" << G4endl;
+
+    const auto& full = summaries[0];
+    const auto& fast = summaries[1];
+    auto fullEvents = static_cast<G4double>(full.nofEvents);
+    auto fastEvents = static_cast<G4double>(fast.nofEvents);
+    for (const auto& [ih, fullSpectrum] : full.spectra)
+    {
+        auto it = fast.spectra.find(ih);
+        if (it == fast.spectra.end() || it->second.bins.size() != fullSpectrum.bins.size()) continue;
+        const auto& fastSpectrum = it->second;
+
+        G4double total[2] = { 0.0, 0.0 };
+        G4double variance[2] = { 0.0, 0.0 };
+        G4double chi2 = 0.0;
+        G4int ndf = 0;
+        for (std::size_t ibin = 1; ibin + 1 < fullSpectrum.bins.size(); ibin++)
+        {
+            auto a = fullSpectrum.bins[ibin][1] / fullEvents;
+            auto va = fullSpectrum.bins[ibin][2] / (fullEvents * fullEvents);
+            auto b = fastSpectrum.bins[ibin][1] / fastEvents;
+            auto vb = fastSpectrum.bins[ibin][2] / (fastEvents * fastEvents);
+            total[0] += a;
+            total[1] += b;
+            variance[0] += va;
+            variance[1] += vb;
+            if (va + vb > 0.0)
+            {
+                chi2 += (a - b) * (a - b) / (va + vb);
+                ndf++;
+            }
+        }
+
+        auto sigma = std::sqrt(variance[0] + variance[1]);
+        G4cout
+            << " Spectrum " << ih << ": full " << total[0] << " +- " << std::sqrt(variance[0])
+            << ", fast " << total[1] << " +- " << std::sqrt(variance[1])
+            << " per event, difference "
+            << ((sigma > 0.0) ? (total[1] - total[0]) / sigma : 0.0) << " sigma, chi2/ndf "
+            << chi2 << "/" << ndf << G4endl;
+    }
+}
+
+G4String ScanManager::GetConfigName(const G4String& mat, G4double thick, G4int nb) const
+{
+    std::ostringstream name;
+    name << fFileName << "_" << mat << "_" << thick / mm << "mm_x" << nb;
+    return name.str();
+}
@@ -0,0 +1,138 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/ScanMessenger.cpp
+/// \brief Implementation of the ScanMessenger class
+
+#include "ScanMessenger.h"
+#include "ScanManager.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+ScanMessenger::ScanMessenger(ScanManager* scan)
+    : fScanManager(scan)
+{
+    fDirectory = new G4UIdirectory("/scan/", false);
+    fDirectory->SetGuidance("UI commands to sweep absorber configurations in one job.");
+
+    fAddMatCmd = new G4UIcmdWithAString("/scan/addMaterial", this);
+    fAddMatCmd->SetGuidance("Add an absorber material to the scan.");
+    fAddMatCmd->SetParameterName("choice", false);
+    fAddMatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAddThickCmd = new G4UIcmdWithADoubleAndUnit("/scan/addThickness", this);
+    fAddThickCmd->SetGuidance("Add an absorber layer thickness to the scan.");
+    fAddThickCmd->SetParameterName("Thick", false);
+    fAddThickCmd->SetRange("Thick>0.");
+    fAddThickCmd->SetUnitCategory("Length");
+    fAddThickCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAddLayerCountCmd = new G4UIcmdWithAnInteger("/scan/addLayerCount", this);
+    fAddLayerCountCmd->SetGuidance("Add a number of identical layers to the scan.");
+    fAddLayerCountCmd->SetGuidance("Defaults to a single layer if none is given.");
+    fAddLayerCountCmd->SetParameterName("nb", false);
+    fAddLayerCountCmd->SetRange("nb>0");
+    fAddLayerCountCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFileNameCmd = new G4UIcmdWithAString("/scan/setFileName", this);
+    fFileNameCmd->SetGuidance("Set the base name of the analysis files.");
+    fFileNameCmd->SetGuidance("The configuration is appended to it.");
+    fFileNameCmd->SetParameterName("name", false);
+    fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fClearCmd = new G4UIcmdWithoutParameter("/scan/clear", this);
+    fClearCmd->SetGuidance("Remove all materials, thicknesses and layer counts.");
+    fClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBeamOnCmd = new G4UIcmdWithAnInteger("/scan/beamOn", this);
+    fBeamOnCmd->SetGuidance("Run the given number of events for every configuration.");
+    fBeamOnCmd->SetParameterName("nofEvents", false);
+    fBeamOnCmd->SetRange("nofEvents>=0");
+    fBeamOnCmd->AvailableForStates(G4State_Idle);
+
+    fCompareFastSimCmd = new G4UIcmdWithAnInteger("/scan/compareFastSim", this);
+    fCompareFastSimCmd->SetGuidance("Run the current configuration with the full and the fast");
+    fCompareFastSimCmd->SetGuidance("simulation of the absorbers and compare the spectra.");
+    fCompareFastSimCmd->SetGuidance("Needs the fast simulation physics (absorber -f 1).");
+    fCompareFastSimCmd->SetGuidance("The transmission tables are prepared before the fast run.");
+    fCompareFastSimCmd->SetParameterName("nofEvents", false);
+    fCompareFastSimCmd->SetRange("nofEvents>0");
+    fCompareFastSimCmd->AvailableForStates(G4State_Idle);
+}
+
+ScanMessenger::~ScanMessenger()
+{
+    delete fAddMatCmd;
+    delete fAddThickCmd;
+    delete fAddLayerCountCmd;
+    delete fFileNameCmd;
+    delete fClearCmd;
+    delete fBeamOnCmd;
+    delete fCompareFastSimCmd;
+    delete fDirectory;
+}
+
+void ScanMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fAddMatCmd)
+    {
+        fScanManager->AddMaterial(newValue);
+    }
+
+    if (command == fAddThickCmd)
+    {
+        fScanManager->AddThickness(fAddThickCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fAddLayerCountCmd)
+    {
+        fScanManager->AddLayerCount(fAddLayerCountCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fFileNameCmd)
+    {
+        fScanManager->SetFileName(newValue);
+    }
+
+    if (command == fClearCmd)
+    {
+        fScanManager->Clear();
+    }
+
+    if (command == fBeamOnCmd)
+    {
+        fScanManager->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));
+    }
+
+    if (command == fCompareFastSimCmd)
+    {
+        fScanManager->CompareFastSimulation(fCompareFastSimCmd->GetNewIntValue(newValue));
+    }
+}
@@ -0,0 +1,158 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/SlabGammaModel.cpp
+/// \brief Implementation of the SlabGammaModel class
+
+#include "SlabGammaModel.h"
+#include "SlabTransmission.h"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Gamma.hh"
+#include "G4DynamicParticle.hh"
+#include "G4VSolid.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+SlabGammaModel::SlabGammaModel(const G4String& name, G4Region* envelope)
+    : G4VFastSimulationModel(name, envelope)
+{
+    SetEnergyRange(50 * keV, 3 * MeV);
+}
+
+G4bool SlabGammaModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return &particle == G4Gamma::Gamma();
+}
+
+void SlabGammaModel::SetEnergyRange(G4double minEnergy, G4double maxEnergy)
+{
+    fMinEnergy = minEnergy;
+    fMaxEnergy = maxEnergy;
+}
+
+G4bool SlabGammaModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    if (!fTransmission) return false;
+
+    auto ekin = fastTrack.GetPrimaryTrack()->GetKineticEnergy();
+    if (ekin < fMinEnergy || ekin > fMaxEnergy || ekin >= fTransmission->GetMaxEnergy()) return false;
+
+    // Only on entering the slab through its front face: the photons
+    // scattered inside are fully simulated and never on it going in
+    auto solid = fastTrack.GetEnvelopeSolid();
+    auto position = fastTrack.GetPrimaryTrackLocalPosition();
+    auto direction = fastTrack.GetPrimaryTrackLocalDirection();
+    return solid->Inside(position) == kSurface
+        && solid->SurfaceNormal(position).z() < 0.0
+        && direction.z() > 0.0;
+}
+
+void SlabGammaModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    auto track = fastTrack.GetPrimaryTrack();
+    auto ekin = track->GetKineticEnergy();
+    auto time = track->GetGlobalTime();
+    auto solid = fastTrack.GetEnvelopeSolid();
+    auto position = fastTrack.GetPrimaryTrackLocalPosition();
+    auto direction = fastTrack.GetPrimaryTrackLocalDirection();
+
+    // Crossing without interaction, along the longer oblique path
+    auto cosAlpha = direction.z();
+    if (G4UniformRand() < std::pow(fTransmission->GetDirectFraction(ekin), 1.0 / cosAlpha))
+    {
+        auto distance = solid->DistanceToOut(position, direction);
+        fastStep.ProposePrimaryTrackFinalPosition(position + distance * direction);
+        fastStep.ProposePrimaryTrackFinalTime(time + distance / c_light);
+        fastStep.ProposePrimaryTrackPathLength(distance);
+        return;
+    }
+
+    // Photons leaving through the exit face, around the point where the
+    // entering photon would have left it
+    auto thickness = solid->DistanceToOut(position, G4ThreeVector(0, 0, 1));
+    auto axisPoint = position + thickness / cosAlpha * direction;
+    auto yield = fTransmission->GetExitYield(ekin);
+    auto nbOfExits = static_cast<G4int>(yield);
+    if (G4UniformRand() < yield - nbOfExits) nbOfExits++;
+
+    struct ExitPhoton
+    {
+        G4double energy;
+        G4ThreeVector position;
+        G4ThreeVector direction;
+    };
+    std::vector<ExitPhoton> exitPhotons;
+    G4double exitEnergy = 0.0;
+    for (G4int k = 0; k < nbOfExits; k++)
+    {
+        auto exit = fTransmission->SampleExit(ekin);
+        auto energy = std::min(exit.energy, ekin - exitEnergy);
+        if (energy <= 0.0) break;
+
+        auto phi = twopi * G4UniformRand();
+        G4ThreeVector transverse(std::cos(phi), std::sin(phi), 0);
+        auto exitPosition = axisPoint + exit.offset * thickness * transverse;
+        if (solid->Inside(exitPosition) == kOutside) continue;
+
+        auto sinTheta = std::sqrt(std::max(0.0, 1.0 - exit.cosTheta * exit.cosTheta));
+        G4ThreeVector exitDirection = sinTheta * transverse;
+        exitDirection.setZ(exit.cosTheta);
+        exitPhotons.push_back({ energy, exitPosition, exitDirection });
+        exitEnergy += energy;
+    }
+    fastStep.ProposeTotalEnergyDeposited(ekin - exitEnergy);
+
+    if (exitPhotons.empty())
+    {
+        fastStep.KillPrimaryTrack();
+        return;
+    }
+
+    // The first photon is the primary, at least delayed by its straight path
+    const auto& first = exitPhotons.front();
+    auto path = (first.position - position).mag();
+    fastStep.ProposePrimaryTrackFinalPosition(first.position);
+    fastStep.ProposePrimaryTrackFinalMomentumDirection(first.direction);
+    fastStep.ProposePrimaryTrackFinalKineticEnergy(first.energy);
+    fastStep.ProposePrimaryTrackFinalTime(time + path / c_light);
+    fastStep.ProposePrimaryTrackPathLength(path);
+
+    fastStep.SetNumberOfSecondaryTracks(static_cast<G4int>(exitPhotons.size()) - 1);
+    for (std::size_t k = 1; k < exitPhotons.size(); k++)
+    {
+        const auto& photon = exitPhotons[k];
+        G4DynamicParticle particle(G4Gamma::Gamma(), photon.direction, photon.energy);
+        fastStep.CreateSecondaryTrack(particle, photon.position,
+            time + (photon.position - position).mag() / c_light);
+    }
+}
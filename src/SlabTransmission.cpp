@@ -0,0 +1,266 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/SlabTransmission.cpp
+/// \brief Implementation of the SlabTransmission class
+
+#include "SlabTransmission.h"
+
+#include "G4AutoLock.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace
+{
+G4Mutex tallyMutex = G4MUTEX_INITIALIZER;
+G4Mutex tablesMutex = G4MUTEX_INITIALIZER;
+
+// Tally of all the threads in the current run
+SlabTransmission::Tally mergedTally;
+
+// Published tables, by material and thickness (in nm)
+std::map<std::pair<G4String, G4long>, std::shared_ptr<const SlabTransmission>> publishedTables;
+
+// Exit angle bin of a direction, and its cos(theta) range
+const G4double angleBinWidth = halfpi / SlabTransmission::kNbOfAngles;
+
+G4int GetAngleBin(G4double cosTheta)
+{
+    auto theta = std::acos(std::clamp(cosTheta, 0.0, 1.0));
+    return std::min(static_cast<G4int>(theta / angleBinWidth), SlabTransmission::kNbOfAngles - 1);
+}
+
+G4int GetOffsetBin(G4double offset)
+{
+    auto bin = static_cast<G4int>(offset / SlabTransmission::kMaxOffset * SlabTransmission::kNbOfOffsets);
+    return std::clamp(bin, 0, SlabTransmission::kNbOfOffsets - 1);
+}
+
+// Sparse line of the non-zero values: count, then index value pairs
+void WriteSparse(std::ostream& output, const std::vector<G4double>& values)
+{
+    std::size_t count = std::count_if(values.begin(), values.end(), [](G4double value) { return value != 0.0; });
+    output << count;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] != 0.0) output << ' ' << i << ' ' << values[i];
+    }
+    output << '\n';
+}
+
+G4bool ReadSparse(std::istream& input, std::vector<G4double>& values)
+{
+    std::size_t count = 0;
+    if (!(input >> count)) return false;
+    for (std::size_t k = 0; k < count; k++)
+    {
+        std::size_t i = 0;
+        G4double value = 0.0;
+        if (!(input >> i >> value) || i >= values.size()) return false;
+        values[i] = value;
+    }
+    return true;
+}
+}
+
+G4int SlabTransmission::Tally::fNbOfBins = 0;
+G4double SlabTransmission::Tally::fMaxEnergy = 0.0;
+
+void SlabTransmission::Tally::SetBins(G4int nbOfBins, G4double maxEnergy)
+{
+    fNbOfBins = nbOfBins;
+    fMaxEnergy = maxEnergy;
+}
+
+void SlabTransmission::Tally::BeginOfRun()
+{
+    fNbOfEvents = 0.0;
+    fDirect = 0.0;
+    fScattered.assign(static_cast<std::size_t>(fNbOfBins) * kNbOfAngles, 0.0);
+    fOffsets.assign(kNbOfAngles * kNbOfOffsets, 0.0);
+}
+
+void SlabTransmission::Tally::Fill(G4bool direct, G4double energy, G4double cosTheta, G4double offset,
+    G4double weight)
+{
+    if (direct)
+    {
+        fDirect += weight;
+        return;
+    }
+
+    auto energyBin = std::clamp(static_cast<G4int>(energy / fMaxEnergy * fNbOfBins), 0, fNbOfBins - 1);
+    auto angleBin = GetAngleBin(cosTheta);
+    fScattered[energyBin * kNbOfAngles + angleBin] += weight;
+    fOffsets[angleBin * kNbOfOffsets + GetOffsetBin(offset)] += weight;
+}
+
+void SlabTransmission::Tally::Merge(G4int nofEvents)
+{
+    G4AutoLock lock(&tallyMutex);
+    if (mergedTally.fScattered.size() != fScattered.size())
+    {
+        mergedTally.fScattered.assign(fScattered.size(), 0.0);
+        mergedTally.fOffsets.assign(fOffsets.size(), 0.0);
+    }
+
+    mergedTally.fNbOfEvents += nofEvents;
+    mergedTally.fDirect += fDirect;
+    for (std::size_t i = 0; i < fScattered.size(); i++) mergedTally.fScattered[i] += fScattered[i];
+    for (std::size_t i = 0; i < fOffsets.size(); i++) mergedTally.fOffsets[i] += fOffsets[i];
+}
+
+SlabTransmission::Tally SlabTransmission::Tally::TakeMerged()
+{
+    G4AutoLock lock(&tallyMutex);
+    auto tally = mergedTally;
+    mergedTally = Tally();
+    return tally;
+}
+
+SlabTransmission::SlabTransmission(G4int nbOfBins, G4double maxEnergy)
+    : fNbOfBins(nbOfBins), fMaxEnergy(maxEnergy),
+    fDirect(nbOfBins, 0.0), fYield(nbOfBins, 0.0),
+    fScattered(nbOfBins, std::vector<G4double>(static_cast<std::size_t>(nbOfBins) * kNbOfAngles, 0.0)),
+    fOffsets(nbOfBins, std::vector<G4double>(kNbOfAngles * kNbOfOffsets, 0.0)),
+    fExitTables(nbOfBins)
+{}
+
+void SlabTransmission::SetBin(G4int inBin, const Tally& tally)
+{
+    if (tally.fNbOfEvents <= 0.0 || tally.fScattered.size() != fScattered[inBin].size()) return;
+
+    fDirect[inBin] = tally.fDirect / tally.fNbOfEvents;
+    fScattered[inBin] = tally.fScattered;
+    fOffsets[inBin] = tally.fOffsets;
+
+    // Per photon which interacts: those of the beam not crossing directly
+    G4double nbOfExits = 0.0;
+    for (auto value : tally.fScattered) nbOfExits += value;
+    auto nbOfInteractions = tally.fNbOfEvents - tally.fDirect;
+    fYield[inBin] = (nbOfInteractions > 0.0) ? nbOfExits / nbOfInteractions : 0.0;
+
+    Finalize(inBin);
+}
+
+void SlabTransmission::Finalize(G4int inBin)
+{
+    fExitTables[inBin].Build(fScattered[inBin]);
+}
+
+G4int SlabTransmission::GetBin(G4double energy) const
+{
+    return std::clamp(static_cast<G4int>(energy / fMaxEnergy * fNbOfBins), 0, fNbOfBins - 1);
+}
+
+SlabTransmission::Exit SlabTransmission::SampleExit(G4double energy) const
+{
+    auto inBin = GetBin(energy);
+    auto cell = static_cast<G4int>(fExitTables[inBin].Sample(G4UniformRand(), G4UniformRand()));
+    auto energyBin = cell / kNbOfAngles;
+    auto angleBin = cell % kNbOfAngles;
+
+    Exit exit;
+    exit.energy = (energyBin + G4UniformRand()) * fMaxEnergy / fNbOfBins;
+
+    // Uniform in solid angle within the angle bin
+    auto cosMax = std::cos(angleBin * angleBinWidth);
+    auto cosMin = std::cos((angleBin + 1) * angleBinWidth);
+    exit.cosTheta = cosMin + (cosMax - cosMin) * G4UniformRand();
+
+    // Offset of the angle bin, uniform within its bin
+    const auto offsets = &fOffsets[inBin][angleBin * kNbOfOffsets];
+    G4double total = 0.0;
+    for (G4int k = 0; k < kNbOfOffsets; k++) total += offsets[k];
+    auto r = G4UniformRand() * total;
+    G4int offsetBin = 0;
+    while (offsetBin < kNbOfOffsets - 1 && r >= offsets[offsetBin])
+    {
+        r -= offsets[offsetBin];
+        offsetBin++;
+    }
+    exit.offset = (offsetBin + G4UniformRand()) * kMaxOffset / kNbOfOffsets;
+    return exit;
+}
+
+G4bool SlabTransmission::Read(std::istream& input)
+{
+    std::string keyword;
+    G4int nbOfAngles = 0, nbOfOffsets = 0;
+    if (!(input >> keyword >> nbOfAngles >> nbOfOffsets) || keyword != "transmission"
+        || nbOfAngles != kNbOfAngles || nbOfOffsets != kNbOfOffsets)
+    {
+        return false;
+    }
+
+    for (G4int inBin = 0; inBin < fNbOfBins; inBin++)
+    {
+        if (!(input >> fDirect[inBin] >> fYield[inBin])
+            || !ReadSparse(input, fScattered[inBin])
+            || !ReadSparse(input, fOffsets[inBin]))
+        {
+            return false;
+        }
+        Finalize(inBin);
+    }
+    return true;
+}
+
+void SlabTransmission::Write(std::ostream& output) const
+{
+    // Per energy bin: the direct fraction and the yield, then the sparse
+    // exit and offset tables on a line each
+    output << "transmission " << kNbOfAngles << ' ' << kNbOfOffsets << '\n';
+    for (G4int inBin = 0; inBin < fNbOfBins; inBin++)
+    {
+        output << fDirect[inBin] << ' ' << fYield[inBin] << ' ';
+        WriteSparse(output, fScattered[inBin]);
+        WriteSparse(output, fOffsets[inBin]);
+    }
+}
+
+void SlabTransmission::Publish(const G4String& material, G4double thickness,
+    std::shared_ptr<const SlabTransmission> transmission)
+{
+    G4AutoLock lock(&tablesMutex);
+    publishedTables[{ material, std::lround(thickness / nm) }] = std::move(transmission);
+}
+
+std::shared_ptr<const SlabTransmission> SlabTransmission::Find(const G4String& material, G4double thickness)
+{
+    G4AutoLock lock(&tablesMutex);
+    auto it = publishedTables.find({ material, std::lround(thickness / nm) });
+    return (it != publishedTables.end()) ? it->second : nullptr;
+}
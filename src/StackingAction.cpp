@@ -0,0 +1,262 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/StackingAction.cpp
+/// \brief Implementation of the StackingAction class
+
+#include "StackingAction.h"
+#include "StackingMessenger.h"
+#include "DetectorConstruction.h"
+#include "RunAction.h"
+#include "PrimaryGeneratorAction.h"
+
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4HadronicProcessType.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4VSolid.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LossTableManager.hh"
+#include "G4EmCalculator.hh"
+#include "G4MaterialCutsCouple.hh"
+#include "G4Electron.hh"
+#include "G4Proton.hh"
+#include "G4Alpha.hh"
+#include "G4NeutrinoE.hh"
+#include "G4AntiNeutrinoE.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+G4bool StackingAction::fSuspended = false;
+
+StackingAction::StackingAction(DetectorConstruction* det, RunAction* runAction,
+    const PrimaryGeneratorAction* primaryGenerator)
+    : fDetConstruction(det), fRunAction(runAction), fPrimaryGenerator(primaryGenerator)
+{
+    fMessenger = new StackingMessenger(this);
+    fRangeRejectionMaxEnergy = 10 * MeV;
+}
+
+StackingAction::~StackingAction()
+{
+    delete fMessenger;
+}
+
+void StackingAction::SetRangeRejectionMaxEnergy(G4double energy)
+{
+    fRangeRejectionMaxEnergy = energy;
+    fElectronMaxEnergies.clear();
+}
+
+void StackingAction::SetRangeRejectionMaxYield(G4double yield)
+{
+    fRangeRejectionMaxYield = yield;
+    fElectronMaxEnergies.clear();
+}
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+    if (fSuspended) return fUrgent;
+
+    if (BiasEmission(track) == fKill) return fKill;
+
+    auto particle = track->GetDefinition();
+    if (fAnalyticNeutrinos
+        && (particle == G4NeutrinoE::Definition() || particle == G4AntiNeutrinoE::Definition()))
+    {
+        // The crossings of a recording plane still need the transport
+        auto phaseSpace = fRunAction->GetPhaseSpace();
+        if (!phaseSpace->IsEnabled() || phaseSpace->GetPlaneMode() == PhaseSpaceWriter::kDetectorEntry)
+        {
+            ScoreNeutrino(track);
+            return fKill;
+        }
+    }
+
+    if (fRangeRejection && IsRangeRejected(track)) return fKill;
+
+    return fUrgent;
+}
+
+G4ClassificationOfNewTrack StackingAction::BiasEmission(const G4Track* track)
+{
+    if (fBiasingMode == kNoBiasing || !IsSourceParticle(track)) return fUrgent;
+
+    auto cosCone = GetConeCosTheta(track->GetPosition());
+    if (cosCone <= -1.0) return fUrgent;
+
+    // The track has not been processed yet, its direction and weight
+    // can still be changed
+    auto biasedTrack = const_cast<G4Track*>(track);
+
+    if (fBiasingMode == kConeBiasing)
+    {
+        G4double cosTheta = 1.0 - G4UniformRand() * (1.0 - cosCone);
+        G4double sinTheta = std::sqrt((1.0 - cosTheta) * (1.0 + cosTheta));
+        G4double phi = twopi * G4UniformRand();
+        biasedTrack->SetMomentumDirection(
+            G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta));
+        biasedTrack->SetWeight(track->GetWeight() * 0.5 * (1.0 - cosCone));
+    }
+    else if (track->GetMomentumDirection().z() < cosCone)
+    {
+        if (G4UniformRand() >= fSurvivalProbability) return fKill;
+        biasedTrack->SetWeight(track->GetWeight() / fSurvivalProbability);
+    }
+
+    return fUrgent;
+}
+
+G4bool StackingAction::IsSourceParticle(const G4Track* track) const
+{
+    auto particle = track->GetDefinition();
+    if (particle->IsGeneralIon()) return false;
+
+    // Beams and replayed phase spaces keep their directions
+    if (track->GetParentID() == 0) return fPrimaryGenerator->HasIsotropicPrimaries();
+
+    auto creator = track->GetCreatorProcess();
+    return creator && creator->GetProcessSubType() == fRadioactiveDecay;
+}
+
+G4double StackingAction::GetConeCosTheta(const G4ThreeVector& position) const
+{
+    // Cone around +z enclosing the front face of the target (the stack,
+    // or the detector when there is no absorber) seen from the emission
+    // point. Returns -1 when no restriction applies (point not upstream)
+    G4double targetZ = (fConeTarget == kDetectorTarget)
+        ? fDetConstruction->GetDetectorFrontZ()
+        : fDetConstruction->GetStackFrontZ();
+    G4double distance = targetZ - position.z();
+    if (distance < 0.0) return -1.0;
+
+    G4double reach = fDetConstruction->GetRadius() + position.perp();
+    return distance / std::sqrt(distance * distance + reach * reach);
+}
+
+G4bool StackingAction::IsRangeRejected(const G4Track* track)
+{
+    // Stable charged particles only: positrons annihilate, ions may decay
+    auto particle = track->GetDefinition();
+    if (particle != G4Electron::Definition() && particle != G4Proton::Definition()
+        && particle != G4Alpha::Definition()) return false;
+
+    auto ekin = track->GetKineticEnergy();
+    if (ekin > fRangeRejectionMaxEnergy) return false;
+
+    // Secondaries have the touchable of their creation point, the
+    // primaries none yet
+    auto touchable = track->GetTouchable();
+    if (!touchable || !touchable->GetVolume()) return false;
+    if (fDetConstruction->GetLayerIndex(touchable->GetVolume(), touchable->GetReplicaNumber()) < 0)
+    {
+        return false;
+    }
+
+    // Distance to the surface of the layer, or of the group of
+    // identical layers around a replica
+    G4int depth = touchable->GetVolume()->IsReplicated() ? 1 : 0;
+    auto history = touchable->GetHistory();
+    auto localPosition = history->GetTransform(history->GetDepth() - depth)
+        .TransformPoint(track->GetPosition());
+    auto safety = touchable->GetSolid(depth)->DistanceToOut(localPosition);
+
+    auto couple = touchable->GetVolume()->GetLogicalVolume()->GetMaterialCutsCouple();
+    if (!couple) return false;
+    if (particle == G4Electron::Definition() && ekin > GetElectronMaxEnergy(couple->GetMaterial()))
+    {
+        return false;
+    }
+
+    // Range with continuous losses below the production cuts, which is
+    // at least the CSDA range
+    auto range = G4LossTableManager::Instance()->GetRange(particle, ekin, couple);
+    return range < safety;
+}
+
+G4double StackingAction::GetElectronMaxEnergy(const G4Material* material)
+{
+    auto it = fElectronMaxEnergies.find(material);
+    if (it != fElectronMaxEnergies.end()) return it->second;
+
+    // Radiative yield Y(E) = (1/E) int_0^E S_rad/S_tot dE', integrated on
+    // a log grid up to the maximum energy; the electrons are rejected up
+    // to the energy where it reaches the tolerance
+    constexpr G4int nbOfPoints = 200;
+    constexpr G4double minEnergy = 1 * keV;
+    G4EmCalculator calculator;
+    auto electron = G4Electron::Definition();
+    auto radiativeFraction = [&](G4double energy)
+    {
+        auto total = calculator.ComputeTotalDEDX(energy, electron, material);
+        return (total > 0.0) ? calculator.ComputeDEDX(energy, electron, "eBrem", material) / total : 0.0;
+    };
+
+    G4double maxEnergy = 0.0;
+    G4double energy = minEnergy;
+    G4double fraction = radiativeFraction(energy);
+    G4double integral = fraction * energy;
+    if (fRangeRejectionMaxEnergy > minEnergy && integral / energy <= fRangeRejectionMaxYield)
+    {
+        maxEnergy = energy;
+        G4double ratio = std::pow(fRangeRejectionMaxEnergy / minEnergy, 1.0 / (nbOfPoints - 1));
+        for (G4int i = 1; i < nbOfPoints; i++)
+        {
+            G4double nextEnergy = energy * ratio;
+            G4double nextFraction = radiativeFraction(nextEnergy);
+            integral += 0.5 * (fraction + nextFraction) * (nextEnergy - energy);
+            if (integral / nextEnergy > fRangeRejectionMaxYield) break;
+            energy = nextEnergy;
+            fraction = nextFraction;
+            maxEnergy = energy;
+        }
+    }
+
+    fElectronMaxEnergies[material] = maxEnergy;
+    return maxEnergy;
+}
+
+void StackingAction::ScoreNeutrino(const G4Track* track)
+{
+    auto distance = fDetConstruction->GetDistanceToCylinder(track->GetPosition(),
+        track->GetMomentumDirection(), fDetConstruction->GetDetectorFrontZ(),
+        fDetConstruction->GetDetectorBackZ());
+    if (distance < 0.0) return;
+
+    // Scored as by the detector, at the entry point
+    auto ekin = track->GetKineticEnergy();
+    if (ekin > 0.0)
+    {
+        auto ih = fRunAction->GetSlot(track->GetDefinition());
+        if (ih) fRunAction->Score(ih, ekin, track->GetWeight());
+    }
+    fRunAction->RecordAt(track, track->GetPosition() + distance * track->GetMomentumDirection(),
+        track->GetGlobalTime() + distance / c_light);
+}
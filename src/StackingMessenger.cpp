@@ -0,0 +1,160 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file absorber/src/StackingMessenger.cpp
+/// \brief Implementation of the StackingMessenger class
+
+#include "StackingMessenger.h"
+#include "StackingAction.h"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+StackingMessenger::StackingMessenger(StackingAction* stacking)
+    : fStackingAction(stacking)
+{
+    fBiasDirectory = new G4UIdirectory("/bias/");
+    fBiasDirectory->SetGuidance("UI commands for variance reduction.");
+
+    fEmissionDirectory = new G4UIdirectory("/bias/emission/");
+    fEmissionDirectory->SetGuidance("Biasing of the source emission direction.");
+
+    fEmissionModeCmd = new G4UIcmdWithAString("/bias/emission/mode", this);
+    fEmissionModeCmd->SetGuidance("Bias the direction of source particles toward");
+    fEmissionModeCmd->SetGuidance("the cone subtended by the absorber/detector:");
+    fEmissionModeCmd->SetGuidance("  none     : isotropic emission,");
+    fEmissionModeCmd->SetGuidance("  cone     : resampled in the cone, weight = cone fraction,");
+    fEmissionModeCmd->SetGuidance("  roulette : outside the cone, Russian roulette.");
+    fEmissionModeCmd->SetParameterName("mode", false);
+    fEmissionModeCmd->SetCandidates("none cone roulette");
+    fEmissionModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fConeTargetCmd = new G4UIcmdWithAString("/bias/emission/target", this);
+    fConeTargetCmd->SetGuidance("Front face enclosed by the biasing cone:");
+    fConeTargetCmd->SetGuidance("  stack    : the absorber stack (default), for a source standing");
+    fConeTargetCmd->SetGuidance("             off the stack; on its front face the cone is the");
+    fConeTargetCmd->SetGuidance("             forward hemisphere,");
+    fConeTargetCmd->SetGuidance("  detector : the detector, seen through the stack.");
+    fConeTargetCmd->SetParameterName("target", false);
+    fConeTargetCmd->SetCandidates("stack detector");
+    fConeTargetCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fSurvivalProbCmd = new G4UIcmdWithADouble("/bias/emission/survivalProbability", this);
+    fSurvivalProbCmd->SetGuidance("Survival probability outside the cone (roulette mode).");
+    fSurvivalProbCmd->SetParameterName("prob", false);
+    fSurvivalProbCmd->SetRange("prob>0. && prob<=1.");
+    fSurvivalProbCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRangeRejectionCmd = new G4UIcmdWithABool("/bias/rangeRejection", this);
+    fRangeRejectionCmd->SetGuidance("Kill the electrons, protons and alphas born in an absorber");
+    fRangeRejectionCmd->SetGuidance("layer with a range shorter than the distance to its surface.");
+    fRangeRejectionCmd->SetGuidance("Biased for photon scoring: the bremsstrahlung of the killed");
+    fRangeRejectionCmd->SetGuidance("electrons is lost (see /bias/rangeRejectionMaxYield).");
+    fRangeRejectionCmd->SetParameterName("value", false);
+    fRangeRejectionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRangeRejectionMaxEnergyCmd = new G4UIcmdWithADoubleAndUnit("/bias/rangeRejectionMaxEnergy", this);
+    fRangeRejectionMaxEnergyCmd->SetGuidance("Set the energy above which particles are not range rejected,");
+    fRangeRejectionMaxEnergyCmd->SetGuidance("their bremsstrahlung could reach the detector.");
+    fRangeRejectionMaxEnergyCmd->SetParameterName("energy", false);
+    fRangeRejectionMaxEnergyCmd->SetRange("energy>=0.");
+    fRangeRejectionMaxEnergyCmd->SetUnitCategory("Energy");
+    fRangeRejectionMaxEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRangeRejectionMaxYieldCmd = new G4UIcmdWithADouble("/bias/rangeRejectionMaxYield", this);
+    fRangeRejectionMaxYieldCmd->SetGuidance("Set the radiative yield (fraction of the energy radiated");
+    fRangeRejectionMaxYieldCmd->SetGuidance("by bremsstrahlung in the layer material) up to which the");
+    fRangeRejectionMaxYieldCmd->SetGuidance("electrons are range rejected (default 1e-3).");
+    fRangeRejectionMaxYieldCmd->SetParameterName("yield", false);
+    fRangeRejectionMaxYieldCmd->SetRange("yield>=0.");
+    fRangeRejectionMaxYieldCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAnalyticNeutrinosCmd = new G4UIcmdWithABool("/bias/analyticNeutrinos", this);
+    fAnalyticNeutrinosCmd->SetGuidance("Score the electron neutrinos at creation when their straight");
+    fAnalyticNeutrinosCmd->SetGuidance("path enters the detector, instead of transporting them.");
+    fAnalyticNeutrinosCmd->SetParameterName("value", false);
+    fAnalyticNeutrinosCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+StackingMessenger::~StackingMessenger()
+{
+    delete fEmissionModeCmd;
+    delete fConeTargetCmd;
+    delete fSurvivalProbCmd;
+    delete fRangeRejectionCmd;
+    delete fRangeRejectionMaxEnergyCmd;
+    delete fRangeRejectionMaxYieldCmd;
+    delete fAnalyticNeutrinosCmd;
+    delete fEmissionDirectory;
+    delete fBiasDirectory;
+}
+
+void StackingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    if (command == fEmissionModeCmd)
+    {
+        auto mode = StackingAction::kNoBiasing;
+        if (newValue == "cone") mode = StackingAction::kConeBiasing;
+        else if (newValue == "roulette") mode = StackingAction::kRouletteBiasing;
+        fStackingAction->SetBiasingMode(mode);
+    }
+
+    if (command == fConeTargetCmd)
+    {
+        fStackingAction->SetConeTarget(
+            newValue == "detector" ? StackingAction::kDetectorTarget : StackingAction::kStackTarget);
+    }
+
+    if (command == fSurvivalProbCmd)
+    {
+        fStackingAction->SetSurvivalProbability(fSurvivalProbCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fRangeRejectionCmd)
+    {
+        fStackingAction->SetRangeRejection(fRangeRejectionCmd->GetNewBoolValue(newValue));
+    }
+
+    if (command == fRangeRejectionMaxEnergyCmd)
+    {
+        fStackingAction->SetRangeRejectionMaxEnergy(
+            fRangeRejectionMaxEnergyCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fRangeRejectionMaxYieldCmd)
+    {
+        fStackingAction->SetRangeRejectionMaxYield(
+            fRangeRejectionMaxYieldCmd->GetNewDoubleValue(newValue));
+    }
+
+    if (command == fAnalyticNeutrinosCmd)
+    {
+        fStackingAction->SetAnalyticNeutrinos(fAnalyticNeutrinosCmd->GetNewBoolValue(newValue));
+    }
+}
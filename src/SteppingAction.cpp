@@ -28,55 +28,241 @@
 /// \brief Implementation of the SteppingAction class
 
 #include "SteppingAction.h"
+#include "DetectorConstruction.h"
 #include "RunAction.h"
 
 #include "G4Step.hh"
-#include "G4PhysicalVolumeStore.hh"
-#include "G4ParticleTypes.hh"
-#include "G4AnalysisManager.hh"
+#include "G4Gamma.hh"
+#include "G4SteppingManager.hh"
+#include "G4GeometryTolerance.hh"
+#include "G4VTouchable.hh"
+#include "G4VPhysicalVolume.hh"
+#include "Randomize.hh"
 
-SteppingAction::SteppingAction(RunAction* runAction)
-    : fRunAction(runAction)
+SteppingAction::SteppingAction(DetectorConstruction* det, RunAction* runAction)
+    : fDetConstruction(det), fRunAction(runAction)
+{}
+
+void SteppingAction::BeginOfRun()
 {
-    fDetector = G4PhysicalVolumeStore::GetInstance()->GetVolume("Detector");
+    // The geometry may have been rebuilt since the previous run
+    fDetector = fDetConstruction->GetDetector();
+    fStepScoring = fDetConstruction->GetScoringMode() == DetectorConstruction::kStepScoring;
+    fExitPlaneScoring = fDetConstruction->GetExitPlaneScoring();
+    fExitZ = fDetConstruction->GetDetectorFrontZ();
+
+    // Phase space recorded at a plane, where the particles are killed
+    auto phaseSpace = fRunAction->GetPhaseSpace();
+    auto planeMode = phaseSpace->GetPlaneMode();
+    fPlaneRecording = phaseSpace->IsEnabled() && planeMode != PhaseSpaceWriter::kDetectorEntry;
+    fPlaneZ = (planeMode == PhaseSpaceWriter::kStackExit)
+        ? fDetConstruction->GetDetectorFrontZ()
+        : phaseSpace->GetPlaneZ();
+
+    fCulling = fDetConstruction->GetAcceptanceCulling();
+    fKeepBackscatter = fDetConstruction->GetKeepBackscatter();
+    fStackFrontZ = fDetConstruction->GetStackFrontZ();
+    fDetectorBackZ = fDetConstruction->GetDetectorBackZ();
+    fRadius = fDetConstruction->GetRadius();
+
+    // Response runs of the photons through a single layer
+    fTransmissionTally = SlabTransmission::Tally::IsEnabled() ? fRunAction->GetTransmissionTally() : nullptr;
+    fSlabThickness = fExitZ - fStackFrontZ;
+
+    fProfiler = fRunAction->GetProfiler();
+    fProfiling = fProfiler->IsEnabled();
+
+    fImportanceBiasing = fDetConstruction->GetImportanceMode() != DetectorConstruction::kNoImportance;
+    if (fImportanceBiasing)
+    {
+        fImportances = fDetConstruction->ComputeImportances();
+        fDetectorImportance = fImportances.empty() ? 1.0 : fImportances.back();
+    }
+
+    fNeeded = fStepScoring || fExitPlaneScoring || fImportanceBiasing || fPlaneRecording || fProfiling || fCulling;
 }
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
+    if (fProfiling) fProfiler->Step(step);
+
     // Collect energy step by step
 
     // Get current step point
     auto stepPoint = step->GetPreStepPoint();
 
-    // Get volume of the current step
-    auto volume = stepPoint->GetTouchableHandle()->GetVolume();
+    if (fExitPlaneScoring)
+    {
+        auto postStepPoint = step->GetPostStepPoint();
+        auto z1 = stepPoint->GetPosition().z();
+        auto z2 = postStepPoint->GetPosition().z();
+        if (z1 < fExitZ && z2 >= fExitZ)
+        {
+            // Scored through the exit face of the stack only, with
+            // the post-step state, as in the plane recording
+            auto f = (fExitZ - z1) / (z2 - z1);
+            auto position = stepPoint->GetPosition()
+                + f * (postStepPoint->GetPosition() - stepPoint->GetPosition());
+            auto track = step->GetTrack();
+            auto ekin = postStepPoint->GetKineticEnergy();
+            if (ekin > 0.0 && position.perp2() <= fRadius * fRadius)
+            {
+                auto ih = fRunAction->GetSlot(track->GetDefinition());
+                if (ih) fRunAction->Score(ih, ekin, track->GetWeight());
+
+                // Photons of the beam on axis, for the transmission tables;
+                // those of the beam which did not interact cross directly
+                if (fTransmissionTally && track->GetDefinition() == G4Gamma::Gamma())
+                {
+                    const auto& direction = postStepPoint->GetMomentumDirection();
+                    G4bool direct = track->GetTrackID() == 1 && ekin == track->GetVertexKineticEnergy()
+                        && direction == track->GetVertexMomentumDirection();
+                    fTransmissionTally->Fill(direct, ekin, direction.z(), position.perp() / fSlabThickness,
+                        track->GetWeight());
+                }
+            }
+            track->SetTrackStatus(fStopAndKill);
+            return;
+        }
+    }
 
-    if (volume == fDetector)
+    if (fPlaneRecording)
     {
-        auto track = step->GetTrack();
-        auto particle = track->GetDefinition();
-        auto charge = particle->GetPDGCharge();
+        auto postStepPoint = step->GetPostStepPoint();
+        auto z1 = stepPoint->GetPosition().z();
+        auto z2 = postStepPoint->GetPosition().z();
+        if (z1 < fPlaneZ && z2 >= fPlaneZ)
+        {
+            // Crossing point on the step, with the post-step state (exact
+            // when the plane is a volume boundary, as the stack exit)
+            auto f = (fPlaneZ - z1) / (z2 - z1);
+            auto position = stepPoint->GetPosition()
+                + f * (postStepPoint->GetPosition() - stepPoint->GetPosition());
+            auto track = step->GetTrack();
+            fRunAction->RecordAt(track, postStepPoint, position);
+            track->SetTrackStatus(fStopAndKill);
+            return;
+        }
+    }
 
+    if (fStepScoring && stepPoint->GetPhysicalVolume() == fDetector)
+    {
+        auto track = step->GetTrack();
         auto ekin = stepPoint->GetKineticEnergy();
 
         // Energy spectrum
         //
         if (ekin > 0.0)
         {
-            G4int ih = 0;
-            if (particle == G4Electron::Electron() ||
-                particle == G4Positron::Positron()) ih = 1;
-            else if (particle == G4NeutrinoE::NeutrinoE() ||
-                particle == G4AntiNeutrinoE::AntiNeutrinoE()) ih = 2;
-            else if (particle == G4Gamma::Gamma()) ih = 3;
-            else if (particle == G4Alpha::Alpha()) ih = 4;
-            else if (charge > 2.0) ih = 5;
-            if (ih)
-            {
-                G4AnalysisManager::Instance()->FillH1(ih, ekin);
-                fRunAction->AddEkin(ih, ekin);
-            }
+            auto ih = fRunAction->GetSlot(track->GetDefinition());
+            if (ih) fRunAction->Score(ih, ekin, track->GetWeight());
         }
+        fRunAction->Record(track, stepPoint);
         track->SetTrackStatus(fStopAndKill);
+        return;
     }
+
+    // Tracks in the world air (the volume without mother) which can
+    // no longer reach the stack or the detector, tested once: where they
+    // enter the world (on the surface they leave), or where they are
+    // born in it
+    if (fCulling)
+    {
+        auto track = step->GetTrack();
+        auto postStepPoint = step->GetPostStepPoint();
+        const G4StepPoint* point = nullptr;
+        if (postStepPoint->GetStepStatus() == fGeomBoundary && IsInWorld(postStepPoint))
+        {
+            point = postStepPoint;
+        }
+        else if (track->GetCurrentStepNumber() == 1 && IsInWorld(stepPoint))
+        {
+            point = stepPoint;
+        }
+
+        if (point && IsCulled(point->GetPosition(), point->GetMomentumDirection()))
+        {
+            track->SetTrackStatus(fStopAndKill);
+            return;
+        }
+    }
+
+    // Splitting or Russian roulette when crossing into a cell
+    // of different importance
+    if (fImportanceBiasing && step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary)
+    {
+        auto importance = GetImportance(step->GetPostStepPoint());
+        auto preImportance = GetImportance(stepPoint);
+        if (importance > 0.0 && preImportance > 0.0 && importance != preImportance)
+        {
+            ApplyImportance(step, importance / preImportance);
+        }
+    }
+}
+
+G4double SteppingAction::GetImportance(const G4StepPoint* point) const
+{
+    // The world air (or outside it) is no cell: 0, never biased
+    auto volume = point->GetPhysicalVolume();
+    if (!volume || !volume->GetMotherLogical()) return 0.0;
+    if (volume == fDetector) return fDetectorImportance;
+
+    auto layer = fDetConstruction->GetLayerIndex(volume, point->GetTouchable()->GetReplicaNumber());
+    return (layer >= 0 && layer < static_cast<G4int>(fImportances.size())) ? fImportances[layer] : 1.0;
+}
+
+void SteppingAction::ApplyImportance(const G4Step* step, G4double ratio)
+{
+    auto track = step->GetTrack();
+
+    if (ratio < 1.0)
+    {
+        // Russian roulette
+        if (G4UniformRand() < ratio) track->SetWeight(track->GetWeight() / ratio);
+        else track->SetTrackStatus(fStopAndKill);
+        return;
+    }
+
+    // Splitting: on average ratio copies, each carrying 1/ratio of the weight
+    G4int nbOfCopies = static_cast<G4int>(ratio);
+    if (G4UniformRand() < ratio - nbOfCopies) nbOfCopies++;
+
+    G4double weight = track->GetWeight() / ratio;
+    track->SetWeight(weight);
+
+    auto postStepPoint = step->GetPostStepPoint();
+    auto secondaries = fpSteppingManager->GetfSecondary();
+    for (G4int i = 1; i < nbOfCopies; i++)
+    {
+        auto copy = new G4Track(new G4DynamicParticle(*track->GetDynamicParticle()),
+            postStepPoint->GetGlobalTime(), postStepPoint->GetPosition());
+        copy->SetWeight(weight);
+        copy->SetParentID(track->GetTrackID());
+        copy->SetTouchableHandle(postStepPoint->GetTouchableHandle());
+        secondaries->push_back(copy);
+    }
+}
+
+G4bool SteppingAction::IsInWorld(const G4StepPoint* point) const
+{
+    auto volume = point->GetPhysicalVolume();
+    return volume && !volume->GetMotherLogical();
+}
+
+G4bool SteppingAction::IsCulled(const G4ThreeVector& position, const G4ThreeVector& direction) const
+{
+    if (fDetConstruction->GetDistanceToCylinder(position, direction, fStackFrontZ, fDetectorBackZ) >= 0.0)
+    {
+        return false;
+    }
+    if (!fKeepBackscatter) return true;
+
+    // Only the tracks which the air cannot send back: outside the
+    // cylinder radius moving outward, or past the detector moving on
+    // (from its surfaces included)
+    auto tolerance = 0.5 * G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+    G4bool leavingRadially = position.perp() >= fRadius - tolerance
+        && position.x() * direction.x() + position.y() * direction.y() >= 0.0;
+    G4bool leavingDownstream = position.z() >= fDetectorBackZ - tolerance && direction.z() >= 0.0;
+    return leavingRadially || leavingDownstream;
 }